@@ -0,0 +1,237 @@
+#pragma once
+#include "vector.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+// Монотонная арена: выделяет память, сдвигая указатель внутри крупных блоков, и освобождает
+// все блоки разом в Release или деструкторе. Освобождение отдельного буфера возвращает память
+// только для последнего выделенного буфера, а последний буфер можно расширить на месте,
+// поэтому растущий в арене вектор обычно не переносит элементы.
+// Арена не потокобезопасна: она рассчитана на один запрос или одну задачу
+class Arena {
+public:
+    explicit Arena(size_t initial_block_size = 4096) noexcept
+        : next_block_size_(std::max(initial_block_size, sizeof(Block))) {
+    }
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    ~Arena() {
+        Release();
+    }
+
+    void* Allocate(size_t bytes, size_t alignment) {
+        size_t padding = Padding(current_, alignment);
+        const size_t available = static_cast<size_t>(end_ - current_);
+        if (current_ == nullptr || padding > available || bytes > available - padding) {
+            AddBlock(bytes, alignment);
+            padding = Padding(current_, alignment);
+        }
+
+        char* p = current_ + padding;
+        current_ = p + bytes;
+        return p;
+    }
+
+    void Deallocate(void* p, size_t bytes, size_t /*alignment*/) noexcept {
+        if (static_cast<char*>(p) + bytes == current_) {
+            current_ = static_cast<char*>(p);
+        }
+    }
+
+    // Расширяет последний выделенный буфер, если он начинается по адресу p и в блоке хватает места
+    bool TryExpand(void* p, size_t old_bytes, size_t new_bytes, size_t /*alignment*/) noexcept {
+        assert(new_bytes >= old_bytes);
+        if (static_cast<char*>(p) + old_bytes != current_
+            || new_bytes - old_bytes > static_cast<size_t>(end_ - current_)) {
+            return false;
+        }
+        current_ += new_bytes - old_bytes;
+        return true;
+    }
+
+    // Освобождает всю память арены. Выделенные из неё буферы становятся недействительными
+    void Release() noexcept {
+        while (head_ != nullptr) {
+            Block* prev = head_->prev;
+            operator delete(head_, head_->size);
+            head_ = prev;
+        }
+        current_ = nullptr;
+        end_ = nullptr;
+    }
+
+private:
+    // Заголовок блока, за которым следует память для буферов
+    struct Block {
+        Block* prev;
+        size_t size;
+    };
+
+    // Количество байт, которое нужно пропустить, чтобы адрес p стал кратен alignment
+    static size_t Padding(const char* p, size_t alignment) noexcept {
+        const auto address = reinterpret_cast<std::uintptr_t>(p);
+        return (alignment - address % alignment) % alignment;
+    }
+
+    void AddBlock(size_t bytes, size_t alignment) {
+        if (bytes > static_cast<size_t>(-1) / 2 - alignment - sizeof(Block)) {
+            throw std::bad_alloc();
+        }
+        // Размер блоков растёт геометрически, чтобы количество блоков было логарифмическим
+        const size_t size = std::max(next_block_size_, sizeof(Block) + alignment + bytes);
+        Block* block = static_cast<Block*>(operator new(size));
+        block->prev = head_;
+        block->size = size;
+        head_ = block;
+        current_ = reinterpret_cast<char*>(block + 1);
+        end_ = reinterpret_cast<char*>(block) + size;
+        next_block_size_ = std::min(size * 2, static_cast<size_t>(-1) / 4);
+    }
+
+    Block* head_ = nullptr;
+    char* current_ = nullptr;
+    char* end_ = nullptr;
+    size_t next_block_size_;
+};
+
+// Пул буферов с размерами-степенями двойки от kMinSize до kMaxSize байт. Освобождённые буферы
+// попадают в список свободных буферов своего размера и переиспользуются без обращения к куче,
+// а новые буферы нарезаются из внутренней арены. Буфер можно расширить на месте, пока
+// новый размер не выходит за его класс. Буферы крупнее kMaxSize выделяются через operator new.
+// Пул не потокобезопасен
+class PoolResource {
+public:
+    static constexpr size_t kMinSize = 16;
+    static constexpr size_t kMaxSize = size_t{1} << 16;
+
+    explicit PoolResource(size_t initial_block_size = 64 * 1024) noexcept
+        : arena_(initial_block_size) {
+    }
+
+    PoolResource(const PoolResource&) = delete;
+    PoolResource& operator=(const PoolResource&) = delete;
+
+    void* Allocate(size_t bytes, size_t alignment) {
+        if (!IsPooled(bytes, alignment)) {
+            return operator new(bytes, std::align_val_t{alignment});
+        }
+        const size_t size_class = SizeClass(bytes);
+        if (FreeBuffer* buffer = free_lists_[size_class]) {
+            free_lists_[size_class] = buffer->next;
+            return buffer;
+        }
+        return arena_.Allocate(ClassSize(size_class), std::min(ClassSize(size_class), alignof(std::max_align_t)));
+    }
+
+    void Deallocate(void* p, size_t bytes, size_t alignment) noexcept {
+        if (!IsPooled(bytes, alignment)) {
+            operator delete(p, bytes, std::align_val_t{alignment});
+            return;
+        }
+        const size_t size_class = SizeClass(bytes);
+        free_lists_[size_class] = new (p) FreeBuffer{free_lists_[size_class]};
+    }
+
+    // Буфер, выделенный мимо пула (крупный или с расширенным выравниванием), на месте не растёт
+    bool TryExpand(void* /*p*/, size_t old_bytes, size_t new_bytes, size_t alignment) noexcept {
+        return IsPooled(old_bytes, alignment) && IsPooled(new_bytes, alignment)
+            && SizeClass(old_bytes) == SizeClass(new_bytes);
+    }
+
+    // Освобождает всю память пула, кроме буферов крупнее kMaxSize
+    void Release() noexcept {
+        std::fill(std::begin(free_lists_), std::end(free_lists_), nullptr);
+        arena_.Release();
+    }
+
+private:
+    struct FreeBuffer {
+        FreeBuffer* next;
+    };
+
+    static constexpr size_t kNumClasses = 13;  // 16, 32, ..., 64 KiB
+    static_assert(kMinSize << (kNumClasses - 1) == kMaxSize);
+    static_assert(kMinSize >= sizeof(FreeBuffer));
+
+    static bool IsPooled(size_t bytes, size_t alignment) noexcept {
+        return bytes <= kMaxSize && alignment <= alignof(std::max_align_t);
+    }
+
+    static size_t SizeClass(size_t bytes) noexcept {
+        size_t size_class = 0;
+        while (ClassSize(size_class) < bytes) {
+            ++size_class;
+        }
+        return size_class;
+    }
+
+    static constexpr size_t ClassSize(size_t size_class) noexcept {
+        return kMinSize << size_class;
+    }
+
+    Arena arena_;
+    FreeBuffer* free_lists_[kNumClasses] = {};
+};
+
+// Аллокатор, берущий память из ресурса (Arena или PoolResource). Копии аллокатора ссылаются
+// на тот же ресурс, который должен пережить все выделенные из него буферы.
+// Vector с таким аллокатором растёт через try_expand ресурса
+template <typename T, typename Resource>
+class ResourceAllocator {
+public:
+    using value_type = T;
+
+    explicit ResourceAllocator(Resource& resource) noexcept
+        : resource_(&resource) {
+    }
+
+    template <typename U>
+    ResourceAllocator(const ResourceAllocator<U, Resource>& other) noexcept
+        : resource_(&other.GetResource()) {
+    }
+
+    T* allocate(size_t n) {
+        if (n > static_cast<size_t>(-1) / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return static_cast<T*>(resource_->Allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* buf, size_t n) noexcept {
+        resource_->Deallocate(buf, n * sizeof(T), alignof(T));
+    }
+
+    bool try_expand(T* buf, size_t old_n, size_t new_n) noexcept {
+        if (new_n > static_cast<size_t>(-1) / sizeof(T)) {
+            return false;
+        }
+        return resource_->TryExpand(buf, old_n * sizeof(T), new_n * sizeof(T), alignof(T));
+    }
+
+    Resource& GetResource() const noexcept {
+        return *resource_;
+    }
+
+    template <typename U>
+    bool operator==(const ResourceAllocator<U, Resource>& other) const noexcept {
+        return resource_ == &other.GetResource();
+    }
+
+    template <typename U>
+    bool operator!=(const ResourceAllocator<U, Resource>& other) const noexcept {
+        return !(*this == other);
+    }
+
+private:
+    Resource* resource_;
+};
+
+template <typename T>
+using ArenaAllocator = ResourceAllocator<T, Arena>;
+
+template <typename T>
+using PoolAllocator = ResourceAllocator<T, PoolResource>;
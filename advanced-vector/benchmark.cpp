@@ -0,0 +1,357 @@
+// Сравнение производительности Vector и std::vector.
+// Сборка: g++ -std=c++17 -O2 -DNDEBUG benchmark.cpp -o benchmark
+// Запуск: ./benchmark [максимальный размер, по умолчанию 1'000'000]
+#include "vector.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+// Счётчики динамических выделений памяти во всей программе
+size_t g_num_allocations = 0;
+size_t g_allocated_bytes = 0;
+
+}  // namespace
+
+void* operator new(size_t size) {
+    ++g_num_allocations;
+    g_allocated_bytes += size;
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+// Память выделяется через malloc, поэтому освобождается через free
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t /*size*/) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+// Тривиально копируемая структура средних размеров
+struct Trivial {
+    int id = 0;
+    double value = 0.0;
+    char tag[16] = {};
+};
+
+// Тяжёлый тип наподобие Obj из тестов: строка в куче и подсчёт перемещений и копирований
+struct Heavy {
+    Heavy() = default;
+
+    explicit Heavy(int id)
+        : id(id)
+        , name("heavy object number " + std::to_string(id)) {
+    }
+
+    Heavy(const Heavy& other)
+        : id(other.id)
+        , name(other.name) {
+        ++num_copied;
+    }
+
+    Heavy(Heavy&& other) noexcept
+        : id(other.id)
+        , name(std::move(other.name)) {
+        ++num_moved;
+    }
+
+    Heavy& operator=(const Heavy& other) {
+        id = other.id;
+        name = other.name;
+        ++num_copied;
+        return *this;
+    }
+
+    Heavy& operator=(Heavy&& other) noexcept {
+        id = other.id;
+        name = std::move(other.name);
+        ++num_moved;
+        return *this;
+    }
+
+    int id = 0;
+    std::string name;
+
+    static inline size_t num_copied = 0;
+    static inline size_t num_moved = 0;
+};
+
+template <typename T>
+T MakeValue(size_t i);
+
+template <>
+int MakeValue<int>(size_t i) {
+    return static_cast<int>(i);
+}
+
+template <>
+Trivial MakeValue<Trivial>(size_t i) {
+    return Trivial{static_cast<int>(i), static_cast<double>(i), "trivial"};
+}
+
+template <>
+std::string MakeValue<std::string>(size_t i) {
+    return "string value number " + std::to_string(i);
+}
+
+template <>
+Heavy MakeValue<Heavy>(size_t i) {
+    return Heavy(static_cast<int>(i));
+}
+
+template <typename T>
+constexpr std::string_view TypeName();
+
+template <>
+constexpr std::string_view TypeName<int>() {
+    return "int";
+}
+
+template <>
+constexpr std::string_view TypeName<Trivial>() {
+    return "Trivial";
+}
+
+template <>
+constexpr std::string_view TypeName<std::string>() {
+    return "string";
+}
+
+template <>
+constexpr std::string_view TypeName<Heavy>() {
+    return "Heavy";
+}
+
+// Единый интерфейс для обоих контейнеров
+template <typename T>
+struct StdVectorOps {
+    using Container = std::vector<T>;
+    static constexpr std::string_view kName = "std::vector";
+
+    static void PushBack(Container& v, const T& value) {
+        v.push_back(value);
+    }
+    static void Reserve(Container& v, size_t n) {
+        v.reserve(n);
+    }
+    static void Resize(Container& v, size_t n) {
+        v.resize(n);
+    }
+    static void InsertMiddle(Container& v, const T& value) {
+        v.insert(v.begin() + v.size() / 2, value);
+    }
+    static void EraseMiddle(Container& v) {
+        v.erase(v.begin() + v.size() / 2);
+    }
+    static size_t Size(const Container& v) {
+        return v.size();
+    }
+};
+
+template <typename T>
+struct VectorOps {
+    using Container = Vector<T>;
+    static constexpr std::string_view kName = "Vector";
+
+    static void PushBack(Container& v, const T& value) {
+        v.PushBack(value);
+    }
+    static void Reserve(Container& v, size_t n) {
+        v.Reserve(n);
+    }
+    static void Resize(Container& v, size_t n) {
+        v.Resize(n);
+    }
+    static void InsertMiddle(Container& v, const T& value) {
+        v.Insert(v.cbegin() + v.Size() / 2, value);
+    }
+    static void EraseMiddle(Container& v) {
+        v.Erase(v.cbegin() + v.Size() / 2);
+    }
+    static size_t Size(const Container& v) {
+        return v.Size();
+    }
+};
+
+// Не даёт компилятору выбросить результат вычислений
+volatile size_t g_sink = 0;
+
+// Не даёт компилятору выбросить запись в память по адресу p
+void DoNotOptimize(const void* p) {
+#if defined(__GNUC__)
+    asm volatile("" : : "g"(p) : "memory");
+#else
+    g_sink = g_sink + reinterpret_cast<std::uintptr_t>(p);
+#endif
+}
+
+struct Measurement {
+    double ns_per_op = 0.0;
+    double allocations = 0.0;
+    double allocated_bytes = 0.0;
+    double moved_bytes = 0.0;
+};
+
+// Выполняет body (возвращающую количество операций) несколько раз, пока суммарное время
+// не превысит порог. Счётчики приводятся к одному запуску body
+template <typename T, typename Body>
+Measurement Measure(Body body) {
+    using Clock = std::chrono::steady_clock;
+    const auto kMinDuration = std::chrono::milliseconds(50);
+    const int kMaxRuns = 1000;
+
+    const size_t old_allocations = g_num_allocations;
+    const size_t old_bytes = g_allocated_bytes;
+    const size_t old_transfers = Heavy::num_moved + Heavy::num_copied;
+
+    size_t ops = 0;
+    int runs = 0;
+    const auto start = Clock::now();
+    auto elapsed = Clock::duration::zero();
+    while (elapsed < kMinDuration && runs < kMaxRuns) {
+        ops += body();
+        ++runs;
+        elapsed = Clock::now() - start;
+    }
+
+    Measurement result;
+    result.ns_per_op = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count())
+                       / static_cast<double>(ops == 0 ? 1 : ops);
+    result.allocations = static_cast<double>(g_num_allocations - old_allocations) / runs;
+    result.allocated_bytes = static_cast<double>(g_allocated_bytes - old_bytes) / runs;
+    // Переносы элементов удаётся посчитать только для типа со счётчиками
+    result.moved_bytes = std::is_same_v<T, Heavy>
+        ? static_cast<double>(Heavy::num_moved + Heavy::num_copied - old_transfers) * sizeof(T) / runs
+        : -1.0;
+    return result;
+}
+
+void PrintHeader() {
+    std::printf("%-16s %-8s %10s %-12s %12s %12s %14s %14s\n", "case", "type", "size", "container",
+                "ns/op", "allocs/run", "bytes/run", "moved/run");
+}
+
+void PrintRow(std::string_view name, std::string_view type, size_t size, std::string_view container,
+              const Measurement& m) {
+    std::printf("%-16.*s %-8.*s %10zu %-12.*s %12.2f %12.1f %14.0f ", static_cast<int>(name.size()), name.data(),
+                static_cast<int>(type.size()), type.data(), size, static_cast<int>(container.size()), container.data(),
+                m.ns_per_op, m.allocations, m.allocated_bytes);
+    if (m.moved_bytes < 0) {
+        std::printf("%14s\n", "-");
+    } else {
+        std::printf("%14.0f\n", m.moved_bytes);
+    }
+}
+
+template <typename T, typename Ops>
+void RunCases(size_t size) {
+    using Container = typename Ops::Container;
+
+    std::vector<T> values;
+    values.reserve(size);
+    for (size_t i = 0; i < size; ++i) {
+        values.push_back(MakeValue<T>(i));
+    }
+
+    auto report = [size](std::string_view name, const Measurement& m) {
+        PrintRow(name, TypeName<T>(), size, Ops::kName, m);
+    };
+
+    report("PushBack", Measure<T>([&] {
+        Container v;
+        for (const T& value : values) {
+            Ops::PushBack(v, value);
+        }
+        g_sink = g_sink + Ops::Size(v);
+        return size;
+    }));
+
+    report("Reserve+fill", Measure<T>([&] {
+        Container v;
+        Ops::Reserve(v, size);
+        for (const T& value : values) {
+            Ops::PushBack(v, value);
+        }
+        g_sink = g_sink + Ops::Size(v);
+        return size;
+    }));
+
+    {
+        // Вставка и удаление в середине: каждая операция сдвигает половину элементов
+        Container v;
+        for (const T& value : values) {
+            Ops::PushBack(v, value);
+        }
+        const size_t num_edits = std::min(size, std::max<size_t>(1'000'000 / size, 1));
+        report("Insert/Erase", Measure<T>([&] {
+            for (size_t i = 0; i < num_edits; ++i) {
+                Ops::InsertMiddle(v, values[i]);
+            }
+            for (size_t i = 0; i < num_edits; ++i) {
+                Ops::EraseMiddle(v);
+            }
+            return 2 * num_edits;
+        }));
+
+        Container target;
+        report("CopyAssign", Measure<T>([&] {
+            target = v;
+            DoNotOptimize(&*target.begin());
+            target = Container{};
+            return size;
+        }));
+
+        report("MoveAssign", Measure<T>([&] {
+            Container tmp;
+            tmp = std::move(v);
+            v = std::move(tmp);
+            return size_t{2};
+        }));
+    }
+
+    report("Resize", Measure<T>([&] {
+        Container v;
+        Ops::Resize(v, size);
+        Ops::Resize(v, size / 2);
+        Ops::Resize(v, size);
+        g_sink = g_sink + Ops::Size(v);
+        return size;
+    }));
+}
+
+template <typename T>
+void RunType(size_t max_size) {
+    for (size_t size = 10; size <= max_size; size *= 100) {
+        RunCases<T, StdVectorOps<T>>(size);
+        RunCases<T, VectorOps<T>>(size);
+    }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const size_t max_size = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1'000'000;
+
+    PrintHeader();
+    RunType<int>(max_size);
+    RunType<Trivial>(max_size);
+    RunType<std::string>(max_size);
+    RunType<Heavy>(max_size);
+}
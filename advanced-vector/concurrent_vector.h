@@ -0,0 +1,260 @@
+#pragma once
+#include "vector.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+
+// Вектор, в который несколько потоков могут добавлять элементы одновременно.
+// Место под элемент резервируется атомарным fetch_add, без блокировок. Элементы хранятся
+// в сегментах RawMemory, размеры которых удваиваются, поэтому уже добавленные элементы никогда
+// не перемещаются, а ссылки на них остаются действительными. Мьютекс захватывается только
+// при выделении нового сегмента, то есть O(log n) раз за всё время жизни вектора.
+//
+// Элемент с индексом, который вернул EmplaceBack, можно читать через operator[] после возврата
+// из EmplaceBack (передав индекс другим потокам через обычную синхронизацию), даже если
+// другие потоки продолжают добавлять элементы. Разрушение вектора, ToVector и TakeVector
+// допустимы только после того, как все добавления завершены
+template <typename T>
+class ConcurrentVector
+{
+public:
+
+    ConcurrentVector() = default;
+
+    ConcurrentVector(const ConcurrentVector&) = delete;
+    ConcurrentVector& operator=(const ConcurrentVector&) = delete;
+
+    ~ConcurrentVector()
+    {
+        ForEachElement([](T& item) {
+            std::destroy_at(&item);
+        });
+    }
+
+    // Добавляет элемент и возвращает его индекс
+    template <typename... Args>
+    size_t EmplaceBack(Args&&... args)
+    {
+        const size_t index = size_.fetch_add(1, std::memory_order_relaxed);
+        const size_t segment = SegmentIndex(index);
+        const size_t offset = index - SegmentStart(segment);
+        // Выделение сегмента тоже может выбросить исключение, а ячейка уже зарезервирована.
+        // Тогда пустой остаётся только эта ячейка, а следующие вызовы снова пробуют выделить сегмент
+        T* data = SegmentFor(segment, offset);
+        try
+        {
+            new (data + offset) T(std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            MarkBroken(segment, offset);
+            throw;
+        }
+        return index;
+    }
+
+    size_t PushBack(const T& value)
+    {
+        return EmplaceBack(value);
+    }
+
+    size_t PushBack(T&& value)
+    {
+        return EmplaceBack(std::move(value));
+    }
+
+    // Количество зарезервированных ячеек, включая элементы, которые ещё конструируются
+    size_t Size() const noexcept
+    {
+        return size_.load(std::memory_order_acquire);
+    }
+
+    const T& operator[](size_t index) const noexcept
+    {
+        return const_cast<ConcurrentVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept
+    {
+        assert(index < Size());
+        const size_t segment = SegmentIndex(index);
+        T* data = segment_ptrs_[segment].load(std::memory_order_acquire);
+        assert(data != nullptr);
+        return data[index - SegmentStart(segment)];
+    }
+
+    // Копирует элементы в непрерывный Vector
+    Vector<T> ToVector() const
+    {
+        return const_cast<ConcurrentVector&>(*this).Export([](T* first, T* last, Vector<T>& result) {
+            result.Append(first, last);
+        });
+    }
+
+    // Перемещает элементы в непрерывный Vector. В ConcurrentVector остаются перемещённые объекты
+    Vector<T> TakeVector()
+    {
+        return Export([](T* first, T* last, Vector<T>& result) {
+            result.Append(std::make_move_iterator(first), std::make_move_iterator(last));
+        });
+    }
+
+private:
+
+    static constexpr size_t kFirstSegmentSize = 32;
+    static constexpr size_t kMaxSegments = 48;
+
+    // Сегмент k содержит kFirstSegmentSize * 2^k элементов
+    static size_t SegmentIndex(size_t index) noexcept
+    {
+        return Log2(index / kFirstSegmentSize + 1);
+    }
+
+    static size_t SegmentStart(size_t segment) noexcept
+    {
+        return kFirstSegmentSize * ((size_t{1} << segment) - 1);
+    }
+
+    static size_t SegmentSize(size_t segment) noexcept
+    {
+        return kFirstSegmentSize << segment;
+    }
+
+    static size_t Log2(size_t value) noexcept
+    {
+#if defined(__GNUC__)
+        return 63 - __builtin_clzll(value);
+#else
+        size_t result = 0;
+        while (value >>= 1)
+        {
+            ++result;
+        }
+        return result;
+#endif
+    }
+
+    // Возвращает сегмент, выделяя его вместе с битовой картой пустых ячеек при необходимости.
+    // Битовая карта выделяется первой: она в 8 * sizeof(T) раз меньше сегмента, и если не выделится
+    // сам сегмент, ячейка offset отмечается в ней как пустая, а выделение повторит следующий вызов.
+    // Только если не выделилась и битовая карта, отметить ячейку негде, и сегмент больше не выделяется
+    T* SegmentFor(size_t segment, size_t offset)
+    {
+        assert(segment < kMaxSegments);
+        if (T* data = segment_ptrs_[segment].load(std::memory_order_acquire))
+        {
+            return data;
+        }
+
+        std::lock_guard guard(mutex_);
+        if (segments_[segment].Capacity() == 0)
+        {
+            if (failed_segments_[segment])
+            {
+                broken_count_.fetch_add(1, std::memory_order_relaxed);
+                throw std::bad_alloc();
+            }
+            if (broken_bits_[segment] == nullptr)
+            {
+                try
+                {
+                    broken_bits_[segment].reset(new std::atomic<uint64_t>[(SegmentSize(segment) + 63) / 64]());
+                }
+                catch (...)
+                {
+                    failed_segments_[segment] = true;
+                    broken_count_.fetch_add(1, std::memory_order_relaxed);
+                    throw;
+                }
+            }
+            try
+            {
+                RawMemory<T> memory(SegmentSize(segment));
+                segments_[segment].Swap(memory);
+            }
+            catch (...)
+            {
+                MarkBroken(segment, offset);
+                throw;
+            }
+            segment_ptrs_[segment].store(segments_[segment].GetAddress(), std::memory_order_release);
+        }
+        return segments_[segment].GetAddress();
+    }
+
+    // Отмечает зарезервированную ячейку пустой. Битовая карта сегмента уже выделена,
+    // поэтому отметка не требует памяти и не может не удаться
+    void MarkBroken(size_t segment, size_t offset) noexcept
+    {
+        broken_bits_[segment][offset / 64].fetch_or(uint64_t{1} << (offset % 64), std::memory_order_relaxed);
+        broken_count_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Обходит сконструированные элементы, пропуская пустые ячейки и невыделенные сегменты
+    template <typename Fn>
+    void ForEachElement(Fn fn)
+    {
+        const size_t size = Size();
+        for (size_t segment = 0; segment < kMaxSegments && SegmentStart(segment) < size; ++segment)
+        {
+            T* data = segments_[segment].GetAddress();
+            if (data == nullptr)
+            {
+                continue;
+            }
+            const std::atomic<uint64_t>* bits = broken_bits_[segment].get();
+            const size_t count = std::min(SegmentSize(segment), size - SegmentStart(segment));
+            for (size_t offset = 0; offset < count; ++offset)
+            {
+                if ((bits[offset / 64].load(std::memory_order_relaxed) >> (offset % 64) & 1) == 0)
+                {
+                    fn(data[offset]);
+                }
+            }
+        }
+    }
+
+    // Переносит элементы в Vector целыми сегментами при помощи append(first, last, result)
+    template <typename AppendRange>
+    Vector<T> Export(AppendRange append)
+    {
+        Vector<T> result;
+        const size_t size = Size();
+
+        if (broken_count_.load(std::memory_order_relaxed) != 0)
+        {
+            size_t count = 0;
+            ForEachElement([&count](T&) {
+                ++count;
+            });
+            result.Reserve(count);
+            ForEachElement([&append, &result](T& item) {
+                append(&item, &item + 1, result);
+            });
+            return result;
+        }
+
+        result.Reserve(size);
+        for (size_t segment = 0; segment < kMaxSegments && SegmentStart(segment) < size; ++segment)
+        {
+            T* first = segments_[segment].GetAddress();
+            append(first, first + std::min(SegmentSize(segment), size - SegmentStart(segment)), result);
+        }
+        return result;
+    }
+
+    std::atomic<size_t> size_{0};
+    std::atomic<T*> segment_ptrs_[kMaxSegments] = {};
+    // Количество пустых ячеек: не сконструированных элементов, ячеек, для которых не выделился сегмент,
+    // и ячеек сегментов, которые больше не выделяются
+    std::atomic<size_t> broken_count_{0};
+
+    // Защищены mutex_ до публикации сегмента в segment_ptrs_
+    std::mutex mutex_;
+    RawMemory<T> segments_[kMaxSegments];
+    std::unique_ptr<std::atomic<uint64_t>[]> broken_bits_[kMaxSegments];
+    bool failed_segments_[kMaxSegments] = {};
+};
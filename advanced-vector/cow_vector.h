@@ -0,0 +1,323 @@
+#pragma once
+#include "vector.h"
+
+#include <atomic>
+
+// Вектор с копированием при записи. Копии CowVector разделяют один неизменяемый буфер
+// со счётчиком ссылок, поэтому копирование стоит одного атомарного инкремента. Первое изменение
+// (EmplaceBack, Erase, Resize и т.д.) копирует буфер, если им пользуется кто-то ещё.
+// Элементы доступны только для чтения: operator[], begin и end константны и никогда не копируют
+// буфер, а изменяющие методы возвращают константные ссылки и итераторы. Произвольная запись идёт
+// через Mutable: пока живёт выданный им объект, буфер принадлежит только этому вектору и копии
+// получают собственный буфер. Ссылки, полученные через него, нельзя использовать после его разрушения.
+//
+// Разные объекты CowVector, разделяющие буфер, можно читать, копировать, изменять и разрушать
+// из разных потоков одновременно, как и std::shared_ptr. Один и тот же объект без внешней
+// синхронизации можно только читать
+template <typename T>
+class CowVector
+{
+    struct Shared;
+
+public:
+
+    // Элементы изменяются только через Mutable, поэтому оба итератора константны, как у std::set
+    using iterator = typename Vector<T>::const_iterator;
+    using const_iterator = typename Vector<T>::const_iterator;
+
+    // Доступ на запись ко всем методам Vector. Пока объект жив, буфер не разделяется с копиями.
+    // Объект не должен переживать вектор, его выдавший, и присваивание этому вектору
+    class MutableScope
+    {
+    public:
+
+        MutableScope(const MutableScope&) = delete;
+        MutableScope& operator=(const MutableScope&) = delete;
+
+        ~MutableScope()
+        {
+            --shared_->scopes;
+        }
+
+        Vector<T>& operator*() const noexcept
+        {
+            return shared_->data;
+        }
+
+        Vector<T>* operator->() const noexcept
+        {
+            return &shared_->data;
+        }
+
+    private:
+
+        friend class CowVector;
+
+        explicit MutableScope(Shared* shared) noexcept
+            : shared_(shared)
+        {
+            ++shared_->scopes;
+        }
+
+        Shared* shared_;
+    };
+
+    CowVector() = default;
+
+    explicit CowVector(size_t size)
+        : shared_(new Shared{{1}, Vector<T>(size)})
+    {
+    }
+
+    // Забирает элементы data без копирования
+    explicit CowVector(Vector<T>&& data)
+        : shared_(new Shared{{1}, std::move(data)})
+    {
+    }
+
+    CowVector(const CowVector& other)
+    {
+        if (other.shared_ == nullptr)
+        {
+            return;
+        }
+        if (other.shared_->scopes != 0)
+        {
+            // Буфер other сейчас изменяется через Mutable, поэтому разделять его нельзя
+            shared_ = new Shared{{1}, other.shared_->data};
+            return;
+        }
+        // Новую ссылку создаёт владелец существующей, поэтому упорядочивание не нужно
+        shared_ = other.shared_;
+        shared_->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    CowVector(CowVector&& other) noexcept
+        : shared_(std::exchange(other.shared_, nullptr))
+    {
+    }
+
+    CowVector& operator=(const CowVector& rhs)
+    {
+        if (this != &rhs)
+        {
+            CowVector tmp(rhs);
+            Swap(tmp);
+        }
+        return *this;
+    }
+
+    CowVector& operator=(CowVector&& rhs) noexcept
+    {
+        if (this != &rhs)
+        {
+            Release();
+            shared_ = std::exchange(rhs.shared_, nullptr);
+        }
+        return *this;
+    }
+
+    ~CowVector()
+    {
+        Release();
+    }
+
+    void Swap(CowVector& other) noexcept
+    {
+        std::swap(shared_, other.shared_);
+    }
+
+    // Количество объектов CowVector, разделяющих буфер (0 для пустого вектора без буфера)
+    size_t UseCount() const noexcept
+    {
+        return shared_ != nullptr ? shared_->refs.load(std::memory_order_acquire) : 0;
+    }
+
+    // Элементы только для чтения. Ссылка действительна до изменения или разрушения этого объекта
+    const Vector<T>& View() const noexcept
+    {
+        static const Vector<T> empty;
+        return shared_ != nullptr ? shared_->data : empty;
+    }
+
+    // Отделяет буфер и даёт доступ на запись, пока жив возвращённый объект
+    MutableScope Mutable()
+    {
+        Detach();
+        return MutableScope(shared_);
+    }
+
+    const_iterator begin() const noexcept
+    {
+        return View().begin();
+    }
+
+    const_iterator end() const noexcept
+    {
+        return View().end();
+    }
+
+    const_iterator cbegin() const noexcept
+    {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept
+    {
+        return end();
+    }
+
+    size_t Size() const noexcept
+    {
+        return View().Size();
+    }
+
+    size_t Capacity() const noexcept
+    {
+        return View().Capacity();
+    }
+
+    const T& operator[](size_t index) const noexcept
+    {
+        return View()[index];
+    }
+
+    void Reserve(size_t new_capacity)
+    {
+        if (new_capacity > Capacity())
+        {
+            Detach(new_capacity);
+            shared_->data.Reserve(new_capacity);
+        }
+    }
+
+    void Resize(size_t new_size)
+    {
+        if (new_size != Size())
+        {
+            Detach(new_size);
+            shared_->data.Resize(new_size);
+        }
+    }
+
+    // Общий буфер не копируется, а просто отпускается
+    void Clear() noexcept
+    {
+        if (UseCount() > 1)
+        {
+            Release();
+        }
+        else if (shared_ != nullptr)
+        {
+            shared_->data.Clear();
+        }
+    }
+
+    template <typename... Args>
+    const T& EmplaceBack(Args&&... args)
+    {
+        const CowVector previous = Detach(Size() + 1);
+        return shared_->data.EmplaceBack(std::forward<Args>(args)...);
+    }
+
+    void PushBack(const T& value)
+    {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value)
+    {
+        EmplaceBack(std::move(value));
+    }
+
+    void PopBack()
+    {
+        assert(Size() > 0);
+        Detach();
+        shared_->data.PopBack();
+    }
+
+    // pos может указывать в общий буфер, поэтому до отделения он переводится в индекс
+    template <typename... Args>
+    iterator Emplace(const_iterator pos, Args&&... args)
+    {
+        const size_t offset = pos - cbegin();
+        const CowVector previous = Detach(Size() + 1);
+        Vector<T>& data = shared_->data;
+        return data.Emplace(data.cbegin() + offset, std::forward<Args>(args)...);
+    }
+
+    iterator Insert(const_iterator pos, const T& value)
+    {
+        return Emplace(pos, value);
+    }
+
+    iterator Insert(const_iterator pos, T&& value)
+    {
+        return Emplace(pos, std::move(value));
+    }
+
+    iterator Erase(const_iterator pos)
+    {
+        assert(pos >= cbegin() && pos < cend());
+        return Erase(pos, pos + 1);
+    }
+
+    iterator Erase(const_iterator first, const_iterator last)
+    {
+        assert(cbegin() <= first && first <= last && last <= cend());
+        const size_t offset = first - cbegin();
+        const size_t count = last - first;
+        Detach();
+        Vector<T>& data = shared_->data;
+        return data.Erase(data.cbegin() + offset, data.cbegin() + offset + count);
+    }
+
+private:
+
+    struct Shared
+    {
+        std::atomic<size_t> refs;
+        Vector<T> data;
+        // Количество живых MutableScope. Меняется только единственным владельцем
+        size_t scopes = 0;
+    };
+
+    // Делает буфер собственным, копируя его, если им пользуется кто-то ещё.
+    // Копия сразу получает ёмкость capacity, чтобы следующее изменение не перевыделяло её.
+    // Возвращает владельца прежнего буфера: аргументы вызова могут ссылаться на его элементы,
+    // поэтому он должен жить до конца изменения, даже если другие владельцы его уже отпустили
+    CowVector Detach(size_t capacity = 0)
+    {
+        CowVector previous;
+        if (shared_ == nullptr)
+        {
+            shared_ = new Shared{{1}, Vector<T>()};
+        }
+        else if (shared_->refs.load(std::memory_order_acquire) != 1)
+        {
+            const Vector<T>& data = shared_->data;
+            Vector<T> copy;
+            copy.Reserve(std::max(capacity, data.Size()));
+            copy.Append(data.begin(), data.end());
+            previous.shared_ = std::exchange(shared_, new Shared{{1}, std::move(copy)});
+        }
+        return previous;
+    }
+
+    // Отпускает ссылку на буфер. Последний владелец должен увидеть все изменения,
+    // сделанные другими владельцами до отпускания, поэтому используется acq_rel
+    void Release() noexcept
+    {
+        if (shared_ != nullptr)
+        {
+            if (shared_->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                delete shared_;
+            }
+            shared_ = nullptr;
+        }
+    }
+
+    Shared* shared_ = nullptr;
+};
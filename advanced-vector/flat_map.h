@@ -0,0 +1,575 @@
+#pragma once
+#include "vector.h"
+
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+
+// Упорядоченный ассоциативный массив поверх двух Vector: отсортированные ключи и значения
+// с теми же индексами. Двоичный поиск просматривает только буфер ключей, а значения
+// не занимают место в кеше, пока не нужны. Разыменование итератора даёт пару ссылок
+// std::pair<const K&, V&>, поэтому работает for (auto [key, value] : map).
+// Одиночные вставки и удаления стоят O(n), пакетные InsertRange и EraseKeys применяют все
+// изменения за один проход (Vector::ApplyEdits).
+// Если изменение выбросит исключение, массив очищается, как std::flat_map, чтобы ключи
+// и значения не разошлись
+template <typename K, typename V, typename Compare = std::less<K>>
+class FlatMap
+{
+    template <bool IsConst>
+    class BasicIterator
+    {
+        using ValuePtr = std::conditional_t<IsConst, const V*, V*>;
+
+    public:
+
+        // Как у std::vector<bool>, reference - не настоящая ссылка, а прокси, однако ключи и значения
+        // лежат в непрерывных буферах, поэтому итератор поддерживает произвольный доступ за O(1)
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = std::pair<K, V>;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::pair<const K&, std::conditional_t<IsConst, const V&, V&>>;
+        using pointer = void;
+
+        BasicIterator() = default;
+
+        BasicIterator(const K* key, ValuePtr value) noexcept
+            : key_(key)
+            , value_(value)
+        {
+        }
+
+        // Неконстантный итератор преобразуется в константный
+        template <bool OtherIsConst, typename = std::enable_if_t<IsConst && !OtherIsConst>>
+        BasicIterator(const BasicIterator<OtherIsConst>& other) noexcept
+            : key_(other.key_)
+            , value_(other.value_)
+        {
+        }
+
+        reference operator*() const noexcept
+        {
+            return {*key_, *value_};
+        }
+
+        const K& Key() const noexcept
+        {
+            return *key_;
+        }
+
+        std::conditional_t<IsConst, const V&, V&> Value() const noexcept
+        {
+            return *value_;
+        }
+
+        BasicIterator& operator++() noexcept
+        {
+            ++key_;
+            ++value_;
+            return *this;
+        }
+
+        BasicIterator operator++(int) noexcept
+        {
+            BasicIterator result = *this;
+            ++*this;
+            return result;
+        }
+
+        BasicIterator& operator--() noexcept
+        {
+            --key_;
+            --value_;
+            return *this;
+        }
+
+        BasicIterator operator--(int) noexcept
+        {
+            BasicIterator result = *this;
+            --*this;
+            return result;
+        }
+
+        reference operator[](difference_type n) const noexcept
+        {
+            return *(*this + n);
+        }
+
+        BasicIterator& operator+=(difference_type n) noexcept
+        {
+            key_ += n;
+            value_ += n;
+            return *this;
+        }
+
+        BasicIterator& operator-=(difference_type n) noexcept
+        {
+            return *this += -n;
+        }
+
+        friend BasicIterator operator+(BasicIterator it, difference_type n) noexcept
+        {
+            return it += n;
+        }
+
+        friend BasicIterator operator+(difference_type n, BasicIterator it) noexcept
+        {
+            return it += n;
+        }
+
+        friend BasicIterator operator-(BasicIterator it, difference_type n) noexcept
+        {
+            return it -= n;
+        }
+
+        friend difference_type operator-(const BasicIterator& lhs, const BasicIterator& rhs) noexcept
+        {
+            return lhs.key_ - rhs.key_;
+        }
+
+        friend bool operator==(const BasicIterator& lhs, const BasicIterator& rhs) noexcept
+        {
+            return lhs.key_ == rhs.key_;
+        }
+
+        friend bool operator!=(const BasicIterator& lhs, const BasicIterator& rhs) noexcept
+        {
+            return lhs.key_ != rhs.key_;
+        }
+
+        friend bool operator<(const BasicIterator& lhs, const BasicIterator& rhs) noexcept
+        {
+            return lhs.key_ < rhs.key_;
+        }
+
+        friend bool operator>(const BasicIterator& lhs, const BasicIterator& rhs) noexcept
+        {
+            return rhs < lhs;
+        }
+
+        friend bool operator<=(const BasicIterator& lhs, const BasicIterator& rhs) noexcept
+        {
+            return !(rhs < lhs);
+        }
+
+        friend bool operator>=(const BasicIterator& lhs, const BasicIterator& rhs) noexcept
+        {
+            return !(lhs < rhs);
+        }
+
+    private:
+
+        friend class BasicIterator<!IsConst>;
+        friend class FlatMap;
+
+        const K* key_ = nullptr;
+        ValuePtr value_ = nullptr;
+    };
+
+public:
+
+    using iterator = BasicIterator<false>;
+    using const_iterator = BasicIterator<true>;
+
+    FlatMap() = default;
+
+    explicit FlatMap(const Compare& comp)
+        : comp_(comp)
+    {
+    }
+
+    // Забирает ключи и значения без копирования и упорядочивает их по ключу.
+    // Из пар с равными ключами остаётся первая
+    FlatMap(Vector<K>&& keys, Vector<V>&& values, const Compare& comp = Compare())
+        : keys_(std::move(keys))
+        , values_(std::move(values))
+        , comp_(comp)
+    {
+        assert(keys_.Size() == values_.Size());
+        SortUnique(keys_, values_);
+    }
+
+    // Диапазон пар ключ-значение. Из пар с равными ключами остаётся первая
+    template <typename InputIt, typename = std::enable_if_t<std::is_convertible_v<
+        typename std::iterator_traits<InputIt>::iterator_category, std::input_iterator_tag>>>
+    FlatMap(InputIt first, InputIt last, const Compare& comp = Compare())
+        : comp_(comp)
+    {
+        for (; first != last; ++first)
+        {
+            const auto& [key, value] = *first;
+            keys_.PushBack(key);
+            values_.PushBack(value);
+        }
+        SortUnique(keys_, values_);
+    }
+
+    FlatMap(std::initializer_list<std::pair<K, V>> items, const Compare& comp = Compare())
+        : FlatMap(items.begin(), items.end(), comp)
+    {
+    }
+
+    iterator begin() noexcept
+    {
+        return {keys_.Data(), values_.Data()};
+    }
+
+    iterator end() noexcept
+    {
+        return {keys_.Data() + Size(), values_.Data() + Size()};
+    }
+
+    const_iterator begin() const noexcept
+    {
+        return {keys_.Data(), values_.Data()};
+    }
+
+    const_iterator end() const noexcept
+    {
+        return {keys_.Data() + Size(), values_.Data() + Size()};
+    }
+
+    const_iterator cbegin() const noexcept
+    {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept
+    {
+        return end();
+    }
+
+    size_t Size() const noexcept
+    {
+        return keys_.Size();
+    }
+
+    // Отсортированные ключи одним непрерывным буфером
+    const Vector<K>& Keys() const noexcept
+    {
+        return keys_;
+    }
+
+    // Значения в порядке ключей
+    const Vector<V>& Values() const noexcept
+    {
+        return values_;
+    }
+
+    iterator LowerBound(const K& key)
+    {
+        return IteratorAt(LowerBoundIndex(key, 0));
+    }
+
+    const_iterator LowerBound(const K& key) const
+    {
+        return IteratorAt(LowerBoundIndex(key, 0));
+    }
+
+    iterator Find(const K& key)
+    {
+        return IteratorAt(FindIndex(key));
+    }
+
+    const_iterator Find(const K& key) const
+    {
+        return IteratorAt(FindIndex(key));
+    }
+
+    bool Contains(const K& key) const
+    {
+        return FindIndex(key) != Size();
+    }
+
+    const V& At(const K& key) const
+    {
+        const size_t index = FindIndex(key);
+        if (index == Size())
+        {
+            throw std::out_of_range("FlatMap: key not found");
+        }
+        return values_[index];
+    }
+
+    V& At(const K& key)
+    {
+        return const_cast<V&>(std::as_const(*this).At(key));
+    }
+
+    // Вставляет значение по умолчанию, если ключа ещё нет
+    V& operator[](const K& key)
+    {
+        return TryEmplace(key).first.Value();
+    }
+
+    // Конструирует значение из args, только если ключа ещё нет
+    template <typename... Args>
+    std::pair<iterator, bool> TryEmplace(const K& key, Args&&... args)
+    {
+        const size_t index = LowerBoundIndex(key, 0);
+        if (index != Size() && !comp_(key, keys_[index]))
+        {
+            return {IteratorAt(index), false};
+        }
+        try
+        {
+            values_.Emplace(values_.cbegin() + index, std::forward<Args>(args)...);
+            keys_.Insert(keys_.cbegin() + index, key);
+        }
+        catch (...)
+        {
+            Clear();
+            throw;
+        }
+        return {IteratorAt(index), true};
+    }
+
+    std::pair<iterator, bool> Insert(const std::pair<K, V>& item)
+    {
+        return TryEmplace(item.first, item.second);
+    }
+
+    std::pair<iterator, bool> Insert(std::pair<K, V>&& item)
+    {
+        return TryEmplace(item.first, std::move(item.second));
+    }
+
+    template <typename M>
+    std::pair<iterator, bool> InsertOrAssign(const K& key, M&& value)
+    {
+        const auto [it, inserted] = TryEmplace(key, std::forward<M>(value));
+        if (!inserted)
+        {
+            it.Value() = std::forward<M>(value);
+        }
+        return {it, inserted};
+    }
+
+    // Добавляет пары диапазона, ключей которых ещё нет: пары упорядочиваются отдельно
+    // и вливаются в массив за один проход. Из пар с равными ключами берётся первая
+    template <typename InputIt, typename = std::enable_if_t<std::is_convertible_v<
+        typename std::iterator_traits<InputIt>::iterator_category, std::input_iterator_tag>>>
+    void InsertRange(InputIt first, InputIt last)
+    {
+        Vector<K> added_keys;
+        Vector<V> added_values;
+        for (; first != last; ++first)
+        {
+            const auto& [key, value] = *first;
+            added_keys.PushBack(key);
+            added_values.PushBack(value);
+        }
+        SortUnique(added_keys, added_values);
+
+        // Ключи и значения получают одинаковые правки. Подряд идущие новые пары,
+        // попадающие в одно место, вставляются одной правкой
+        Vector<VectorEdit<K>> key_edits;
+        Vector<VectorEdit<V>> value_edits;
+        size_t position = 0;
+        for (size_t i = 0; i < added_keys.Size(); ++i)
+        {
+            position = LowerBoundIndex(added_keys[i], position);
+            if (position != Size() && !comp_(added_keys[i], keys_[position]))
+            {
+                continue;
+            }
+            if (key_edits.Size() != 0)
+            {
+                VectorEdit<K>& last_edit = key_edits[key_edits.Size() - 1];
+                if (last_edit.position == position && last_edit.values + last_edit.insert_count == added_keys.Data() + i)
+                {
+                    ++last_edit.insert_count;
+                    ++value_edits[value_edits.Size() - 1].insert_count;
+                    continue;
+                }
+            }
+            key_edits.PushBack(VectorEdit<K>::Insert(position, added_keys[i]));
+            value_edits.PushBack(VectorEdit<V>::Insert(position, added_values[i]));
+        }
+
+        try
+        {
+            values_.ApplyEdits(value_edits);
+            keys_.ApplyEdits(key_edits);
+        }
+        catch (...)
+        {
+            Clear();
+            throw;
+        }
+    }
+
+    void InsertRange(std::initializer_list<std::pair<K, V>> items)
+    {
+        InsertRange(items.begin(), items.end());
+    }
+
+    // Добавляет пары other, ключей которых ещё нет в массиве
+    void Merge(const FlatMap& other)
+    {
+        InsertRange(other.begin(), other.end());
+    }
+
+    // Возвращает итератор на пару, следующую за удалённой
+    iterator Erase(const_iterator pos)
+    {
+        const size_t index = pos.key_ - keys_.Data();
+        assert(index < Size());
+        try
+        {
+            keys_.Erase(keys_.cbegin() + index);
+            values_.Erase(values_.cbegin() + index);
+        }
+        catch (...)
+        {
+            Clear();
+            throw;
+        }
+        return IteratorAt(index);
+    }
+
+    size_t Erase(const K& key)
+    {
+        const size_t index = FindIndex(key);
+        if (index == Size())
+        {
+            return 0;
+        }
+        Erase(IteratorAt(index));
+        return 1;
+    }
+
+    // Удаляет ключи диапазона вместе со значениями за один проход.
+    // Возвращает количество удалённых пар
+    template <typename InputIt>
+    size_t EraseKeys(InputIt first, InputIt last)
+    {
+        Vector<size_t> positions;
+        for (; first != last; ++first)
+        {
+            const size_t index = FindIndex(*first);
+            if (index != Size())
+            {
+                positions.PushBack(index);
+            }
+        }
+        std::sort(positions.begin(), positions.end());
+        positions.Erase(std::unique(positions.begin(), positions.end()), positions.cend());
+
+        // Соседние удаляемые пары удаляются одной правкой
+        Vector<VectorEdit<K>> key_edits;
+        Vector<VectorEdit<V>> value_edits;
+        for (size_t position : positions)
+        {
+            if (key_edits.Size() != 0)
+            {
+                VectorEdit<K>& last_edit = key_edits[key_edits.Size() - 1];
+                if (last_edit.position + last_edit.erase_count == position)
+                {
+                    ++last_edit.erase_count;
+                    ++value_edits[value_edits.Size() - 1].erase_count;
+                    continue;
+                }
+            }
+            key_edits.PushBack(VectorEdit<K>::Erase(position));
+            value_edits.PushBack(VectorEdit<V>::Erase(position));
+        }
+
+        try
+        {
+            keys_.ApplyEdits(key_edits);
+            values_.ApplyEdits(value_edits);
+        }
+        catch (...)
+        {
+            Clear();
+            throw;
+        }
+        return positions.Size();
+    }
+
+    size_t EraseKeys(std::initializer_list<K> keys)
+    {
+        return EraseKeys(keys.begin(), keys.end());
+    }
+
+    void Clear() noexcept
+    {
+        keys_.Clear();
+        values_.Clear();
+    }
+
+    void Reserve(size_t new_capacity)
+    {
+        keys_.Reserve(new_capacity);
+        values_.Reserve(new_capacity);
+    }
+
+private:
+
+    iterator IteratorAt(size_t index) noexcept
+    {
+        return {keys_.Data() + index, values_.Data() + index};
+    }
+
+    const_iterator IteratorAt(size_t index) const noexcept
+    {
+        return {keys_.Data() + index, values_.Data() + index};
+    }
+
+    // Индекс первого ключа не меньше key, поиск начинается с индекса from
+    size_t LowerBoundIndex(const K& key, size_t from) const
+    {
+        return std::lower_bound(keys_.Data() + from, keys_.Data() + Size(), key, comp_) - keys_.Data();
+    }
+
+    // Индекс ключа key или Size(), если его нет
+    size_t FindIndex(const K& key) const
+    {
+        const size_t index = LowerBoundIndex(key, 0);
+        return index != Size() && !comp_(key, keys_[index]) ? index : Size();
+    }
+
+    // Упорядочивает пары (keys[i], values[i]) по ключу, оставляя из равных ключей первую пару.
+    // Уже упорядоченные ключи (например, из другого FlatMap) только проверяются за один проход
+    void SortUnique(Vector<K>& keys, Vector<V>& values) const
+    {
+        const auto not_less = [this](const K& lhs, const K& rhs) {
+            return !comp_(lhs, rhs);
+        };
+        if (std::adjacent_find(keys.begin(), keys.end(), not_less) == keys.end())
+        {
+            return;
+        }
+
+        Vector<size_t> order(keys.Size());
+        std::iota(order.begin(), order.end(), size_t{0});
+        std::stable_sort(order.begin(), order.end(), [this, &keys](size_t lhs, size_t rhs) {
+            return comp_(keys[lhs], keys[rhs]);
+        });
+
+        Vector<K> sorted_keys;
+        Vector<V> sorted_values;
+        sorted_keys.Reserve(keys.Size());
+        sorted_values.Reserve(values.Size());
+        for (size_t i : order)
+        {
+            if (sorted_keys.Size() != 0 && !comp_(sorted_keys[sorted_keys.Size() - 1], keys[i]))
+            {
+                continue;
+            }
+            sorted_keys.PushBack(std::move(keys[i]));
+            sorted_values.PushBack(std::move(values[i]));
+        }
+        keys.Swap(sorted_keys);
+        values.Swap(sorted_values);
+    }
+
+    Vector<K> keys_;
+    Vector<V> values_;
+    Compare comp_;
+};
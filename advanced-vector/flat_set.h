@@ -0,0 +1,286 @@
+#pragma once
+#include "vector.h"
+
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <utility>
+
+// Упорядоченное множество поверх Vector: ключи лежат в одном отсортированном буфере,
+// поиск выполняется двоичным поиском без обхода узлов по указателям, как в std::set.
+// Одиночные Insert и Erase сдвигают хвост и стоят O(n), поэтому много ключей лучше добавлять
+// и удалять пакетно: InsertRange и EraseKeys применяют все изменения за один проход (Vector::ApplyEdits).
+// Если пакетное изменение выбросит исключение, множество очищается, как std::flat_set
+template <typename K, typename Compare = std::less<K>>
+class FlatSet
+{
+public:
+
+    // Ключи нельзя менять на месте, иначе нарушится порядок
+    using iterator = typename Vector<K>::const_iterator;
+    using const_iterator = iterator;
+
+    FlatSet() = default;
+
+    explicit FlatSet(const Compare& comp)
+        : comp_(comp)
+    {
+    }
+
+    // Забирает ключи keys без копирования, сортирует их и удаляет повторы
+    explicit FlatSet(Vector<K>&& keys, const Compare& comp = Compare())
+        : keys_(std::move(keys))
+        , comp_(comp)
+    {
+        SortUnique(keys_);
+    }
+
+    template <typename InputIt, typename = std::enable_if_t<std::is_convertible_v<
+        typename std::iterator_traits<InputIt>::iterator_category, std::input_iterator_tag>>>
+    FlatSet(InputIt first, InputIt last, const Compare& comp = Compare())
+        : comp_(comp)
+    {
+        keys_.Append(first, last);
+        SortUnique(keys_);
+    }
+
+    FlatSet(std::initializer_list<K> keys, const Compare& comp = Compare())
+        : FlatSet(keys.begin(), keys.end(), comp)
+    {
+    }
+
+    const_iterator begin() const noexcept
+    {
+        return keys_.begin();
+    }
+
+    const_iterator end() const noexcept
+    {
+        return keys_.end();
+    }
+
+    const_iterator cbegin() const noexcept
+    {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept
+    {
+        return end();
+    }
+
+    size_t Size() const noexcept
+    {
+        return keys_.Size();
+    }
+
+    // Отсортированные ключи одним непрерывным буфером
+    const Vector<K>& Keys() const noexcept
+    {
+        return keys_;
+    }
+
+    // Забирает отсортированные ключи, оставляя множество пустым
+    Vector<K> Extract() &&
+    {
+        return std::move(keys_);
+    }
+
+    const_iterator LowerBound(const K& key) const
+    {
+        return std::lower_bound(begin(), end(), key, comp_);
+    }
+
+    const_iterator UpperBound(const K& key) const
+    {
+        return std::upper_bound(begin(), end(), key, comp_);
+    }
+
+    const_iterator Find(const K& key) const
+    {
+        const const_iterator it = LowerBound(key);
+        return it != end() && !comp_(key, *it) ? it : end();
+    }
+
+    bool Contains(const K& key) const
+    {
+        return Find(key) != end();
+    }
+
+    std::pair<iterator, bool> Insert(const K& key)
+    {
+        return InsertOne(key);
+    }
+
+    std::pair<iterator, bool> Insert(K&& key)
+    {
+        return InsertOne(std::move(key));
+    }
+
+    // Добавляет ключи диапазона: они сортируются отдельно и вливаются в множество за один проход
+    template <typename InputIt, typename = std::enable_if_t<std::is_convertible_v<
+        typename std::iterator_traits<InputIt>::iterator_category, std::input_iterator_tag>>>
+    void InsertRange(InputIt first, InputIt last)
+    {
+        Vector<K> added;
+        added.Append(first, last);
+        SortUnique(added);
+
+        // Подряд идущие новые ключи, попадающие в одно место, вставляются одной правкой
+        Vector<VectorEdit<K>> edits;
+        size_t position = 0;
+        for (size_t i = 0; i < added.Size(); ++i)
+        {
+            position = LowerBoundIndex(added[i], position);
+            if (position != Size() && !comp_(added[i], keys_[position]))
+            {
+                continue;
+            }
+            if (edits.Size() != 0)
+            {
+                VectorEdit<K>& last_edit = edits[edits.Size() - 1];
+                if (last_edit.position == position && last_edit.values + last_edit.insert_count == added.Data() + i)
+                {
+                    ++last_edit.insert_count;
+                    continue;
+                }
+            }
+            edits.PushBack(VectorEdit<K>::Insert(position, added[i]));
+        }
+
+        try
+        {
+            keys_.ApplyEdits(edits);
+        }
+        catch (...)
+        {
+            Clear();
+            throw;
+        }
+    }
+
+    void InsertRange(std::initializer_list<K> keys)
+    {
+        InsertRange(keys.begin(), keys.end());
+    }
+
+    // Добавляет ключи other, которых ещё нет в множестве
+    void Merge(const FlatSet& other)
+    {
+        InsertRange(other.begin(), other.end());
+    }
+
+    // Возвращает итератор на ключ, следующий за удалённым
+    iterator Erase(const_iterator pos)
+    {
+        return keys_.Erase(pos);
+    }
+
+    size_t Erase(const K& key)
+    {
+        const const_iterator it = Find(key);
+        if (it == end())
+        {
+            return 0;
+        }
+        keys_.Erase(it);
+        return 1;
+    }
+
+    // Удаляет ключи диапазона за один проход по множеству. Возвращает количество удалённых ключей
+    template <typename InputIt>
+    size_t EraseKeys(InputIt first, InputIt last)
+    {
+        Vector<K> removed;
+        removed.Append(first, last);
+        SortUnique(removed);
+
+        // Соседние удаляемые ключи удаляются одной правкой
+        Vector<VectorEdit<K>> edits;
+        size_t count = 0;
+        size_t position = 0;
+        for (const K& key : removed)
+        {
+            position = LowerBoundIndex(key, position);
+            if (position == Size() || comp_(key, keys_[position]))
+            {
+                continue;
+            }
+            ++count;
+            if (edits.Size() != 0)
+            {
+                VectorEdit<K>& last_edit = edits[edits.Size() - 1];
+                if (last_edit.position + last_edit.erase_count == position)
+                {
+                    ++last_edit.erase_count;
+                    continue;
+                }
+            }
+            edits.PushBack(VectorEdit<K>::Erase(position));
+        }
+
+        try
+        {
+            keys_.ApplyEdits(edits);
+        }
+        catch (...)
+        {
+            Clear();
+            throw;
+        }
+        return count;
+    }
+
+    size_t EraseKeys(std::initializer_list<K> keys)
+    {
+        return EraseKeys(keys.begin(), keys.end());
+    }
+
+    void Clear() noexcept
+    {
+        keys_.Clear();
+    }
+
+    void Reserve(size_t new_capacity)
+    {
+        keys_.Reserve(new_capacity);
+    }
+
+private:
+
+    template <typename Key>
+    std::pair<iterator, bool> InsertOne(Key&& key)
+    {
+        const const_iterator it = LowerBound(key);
+        if (it != end() && !comp_(key, *it))
+        {
+            return {it, false};
+        }
+        return {keys_.Insert(it, std::forward<Key>(key)), true};
+    }
+
+    // Индекс первого ключа не меньше key, поиск начинается с индекса from
+    size_t LowerBoundIndex(const K& key, size_t from) const
+    {
+        return std::lower_bound(begin() + from, end(), key, comp_) - begin();
+    }
+
+    // Сортирует ключи и удаляет повторы. Уже упорядоченные ключи (например, из другого FlatSet)
+    // только проверяются за один проход
+    void SortUnique(Vector<K>& keys) const
+    {
+        const auto not_less = [this](const K& lhs, const K& rhs) {
+            return !comp_(lhs, rhs);
+        };
+        if (std::adjacent_find(keys.begin(), keys.end(), not_less) == keys.end())
+        {
+            return;
+        }
+        std::sort(keys.begin(), keys.end(), comp_);
+        keys.Erase(std::unique(keys.begin(), keys.end(), not_less), keys.cend());
+    }
+
+    Vector<K> keys_;
+    Compare comp_;
+};
@@ -1,10 +1,37 @@
 #include "vector.h"
+#include "small_vector.h"
+#include "concurrent_vector.h"
+#include "mmap_allocator.h"
+#include "mapped_vector.h"
+#include "arena.h"
+#include "static_vector.h"
+#include "soa_vector.h"
+#include "vector_algorithms.h"
+#include "segmented_vector.h"
+#include "cow_vector.h"
+#include "vector_io.h"
+#include "numa_allocator.h"
+#include "flat_set.h"
+#include "flat_map.h"
+#include "vector_pool.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <csignal>
+#include <cstring>
 #include <iostream>
+#include <list>
+#include <map>
+#include <sstream>
+#include <set>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <vector>
 
+#include <sys/wait.h>
+
 namespace {
 
 // "Магическое" число, используемое для отслеживания живости объекта
@@ -432,7 +459,7 @@ void Test6() {
     {
         Obj::ResetCounters();
         Vector<Obj> v;
-        auto* pos = v.Emplace(v.end(), Obj{1});
+        auto pos = v.Emplace(v.end(), Obj{1});
         assert(v.Size() == 1);
         assert(v.Capacity() >= v.Size());
         assert(&*pos == &v[0]);
@@ -447,7 +474,7 @@ void Test6() {
         Obj::ResetCounters();
         Vector<Obj> v;
         v.Reserve(SIZE);
-        auto* pos = v.Emplace(v.end(), Obj{1});
+        auto pos = v.Emplace(v.end(), Obj{1});
         assert(v.Size() == 1);
         assert(v.Capacity() >= v.Size());
         assert(&*pos == &v[0]);
@@ -494,7 +521,7 @@ void Test6() {
     {
         Obj::ResetCounters();
         Vector<Obj> v{SIZE};
-        auto* pos = v.Emplace(v.cbegin() + 1, ID, "Ivan"s);
+        auto pos = v.Emplace(v.cbegin() + 1, ID, "Ivan"s);
         assert(v.Size() == SIZE + 1);
         assert(v.Capacity() == SIZE * 2);
         assert(&*pos == &v[1]);
@@ -510,7 +537,7 @@ void Test6() {
     {
         Obj::ResetCounters();
         Vector<Obj> v{SIZE};
-        auto* pos = v.Emplace(v.cbegin() + v.Size(), ID, "Ivan"s);
+        auto pos = v.Emplace(v.cbegin() + v.Size(), ID, "Ivan"s);
         assert(v.Size() == SIZE + 1);
         assert(v.Capacity() == SIZE * 2);
         assert(&*pos == &v[SIZE]);
@@ -529,7 +556,7 @@ void Test6() {
         v.Reserve(SIZE * 2);
         const int old_num_moved = Obj::num_moved;
         assert(v.Capacity() == SIZE * 2);
-        auto* pos = v.Emplace(v.cbegin() + 3, ID, "Ivan"s);
+        auto pos = v.Emplace(v.cbegin() + 3, ID, "Ivan"s);
         assert(v.Size() == SIZE + 1);
         assert(&*pos == &v[3]);
         assert(v[3].id == ID);
@@ -538,14 +565,14 @@ void Test6() {
         assert(Obj::num_default_constructed == SIZE);
         assert(Obj::num_constructed_with_id_and_name == 1);
         assert(Obj::num_moved == old_num_moved + 1);
-        assert(Obj::num_move_assigned == SIZE - 3);
+        assert(Obj::num_move_assigned == SIZE - 4);
         assert(Obj::num_assigned == 0);
     }
     {
         Obj::ResetCounters();
         Vector<Obj> v{SIZE};
         v[2].id = ID;
-        auto* pos = v.Erase(v.cbegin() + 1);
+        auto pos = v.Erase(v.cbegin() + 1);
         assert((pos - v.begin()) == 1);
         assert(v.Size() == SIZE - 1);
         assert(v.Capacity() == SIZE);
@@ -558,83 +585,2112 @@ void Test6() {
     }
 }
 
-struct C {
-    C() noexcept {
-        ++def_ctor;
+void Test7() {
+    const size_t SIZE = 100'500;
+    {
+        Vector<int> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(static_cast<int>(i));
+        }
+        v.Insert(v.cbegin() + 1, -1);
+        assert(v.Size() == SIZE + 1);
+        assert(v[0] == 0 && v[1] == -1 && v[2] == 1);
+        assert(v[SIZE] == static_cast<int>(SIZE - 1));
+    }
+    {
+        static_assert(IsTriviallyRelocatableV<std::unique_ptr<int>>);
+        Vector<std::unique_ptr<int>> v;
+        for (int i = 0; i < 128; ++i) {
+            v.EmplaceBack(std::make_unique<int>(i));
+        }
+        assert(v.Size() == v.Capacity());
+        v.Emplace(v.cbegin(), std::make_unique<int>(-1));
+        assert(*v[0] == -1);
+        for (int i = 0; i < 128; ++i) {
+            assert(*v[i + 1] == i);
+        }
     }
-    C(const C& /*other*/) noexcept {
-        ++copy_ctor;
+}
+
+// Аллокатор с состоянием, подсчитывающий выделения. Аллокаторы с разными id не равны
+template <typename T>
+struct CountingAllocator {
+    using value_type = T;
+
+    explicit CountingAllocator(int id = 0) noexcept
+        : id(id) {
     }
-    C(C&& /*other*/) noexcept {
-        ++move_ctor;
+
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>& other) noexcept
+        : id(other.id) {
     }
-    C& operator=(const C& other) noexcept {
-        if (this != &other) {
-            ++copy_assign;
+
+    T* allocate(size_t n) {
+        ++num_allocations;
+        return static_cast<T*>(operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t /*n*/) noexcept {
+        ++num_deallocations;
+        operator delete(p);
+    }
+
+    bool operator==(const CountingAllocator& other) const noexcept {
+        return id == other.id;
+    }
+
+    bool operator!=(const CountingAllocator& other) const noexcept {
+        return id != other.id;
+    }
+
+    int id = 0;
+
+    static inline int num_allocations = 0;
+    static inline int num_deallocations = 0;
+};
+
+void Test8() {
+    const size_t SIZE = 10;
+    using Alloc = CountingAllocator<Obj>;
+    static_assert(sizeof(RawMemory<int>) == sizeof(int*) + sizeof(size_t));
+    {
+        Obj::ResetCounters();
+        Vector<Obj, Alloc> v(SIZE, Alloc{1});
+        v.PushBack(Obj{1});
+        assert(v.GetAllocator().id == 1);
+        assert(Alloc::num_allocations == 2);
+        assert(Alloc::num_deallocations == 1);
+
+        Vector<Obj, Alloc> v_copy(v);
+        assert(v_copy.Size() == SIZE + 1);
+        assert(v_copy.GetAllocator().id == 1);
+
+        // Аллокатор не распространяется при перемещении, поэтому элементы перемещаются поштучно
+        Vector<Obj, Alloc> other(Alloc{2});
+        const int old_num_moved = Obj::num_moved;
+        other = std::move(v);
+        assert(other.GetAllocator().id == 2);
+        assert(other.Size() == SIZE + 1);
+        assert(Obj::num_moved == old_num_moved + static_cast<int>(SIZE + 1));
+
+        Vector<Obj, Alloc> same(Alloc{1});
+        same = std::move(v_copy);
+        assert(same.Size() == SIZE + 1);
+        assert(v_copy.Size() == 0);
+    }
+    assert(Alloc::num_allocations == Alloc::num_deallocations);
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+struct alignas(64) OverAligned {
+    float values[3] = {};
+};
+
+void Test9() {
+    {
+        Vector<OverAligned> v;
+        for (int i = 0; i < 100; ++i) {
+            v.EmplaceBack();
+            assert(reinterpret_cast<std::uintptr_t>(v.Data()) % alignof(OverAligned) == 0);
         }
-        return *this;
     }
-    C& operator=(C&& /*other*/) noexcept {
-        ++move_assign;
-        return *this;
+    {
+        AlignedVector<float, 32> v(7);
+        assert(reinterpret_cast<std::uintptr_t>(v.Data()) % 32 == 0);
+        v.Reserve(1000);
+        assert(reinterpret_cast<std::uintptr_t>(v.Data()) % 32 == 0);
+        assert(v.Size() == 7 && v[6] == 0.0f);
+    }
+    {
+        AlignedVector<char> v;
+        v.PushBack('a');
+        assert(reinterpret_cast<std::uintptr_t>(v.Data()) % kCacheLineSize == 0);
+    }
+}
+
+void Test10() {
+    using namespace std::literals;
+    const int ID = 42;
+    {
+        Obj::ResetCounters();
+        SmallVector<Obj, 4> v;
+        assert(v.IsInline());
+        assert(v.Capacity() == 4);
+        for (int i = 0; i < 4; ++i) {
+            v.EmplaceBack(i, "inline"s);
+        }
+        assert(v.IsInline());
+        assert(Obj::num_moved == 0);
+
+        v.Emplace(v.cbegin() + 1, ID);
+        assert(!v.IsInline());
+        assert(v.Capacity() == 8);
+        assert(v.Size() == 5);
+        assert(v[0].id == 0 && v[1].id == ID && v[2].id == 1 && v[4].id == 3);
+        assert(Obj::num_moved == 4);
+
+        v.Erase(v.cbegin());
+        assert(v.Size() == 4 && v[0].id == ID);
+        assert(Obj::GetAliveObjectCount() == 4);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        // Вставка в середину без реаллокации не создаёт временного объекта
+        Obj::ResetCounters();
+        SmallVector<Obj, 8> v(5);
+        for (int i = 0; i < 5; ++i) {
+            v[i].id = i;
+        }
+        v.Insert(v.cbegin() + 1, Obj{ID});
+        assert(v.IsInline());
+        assert(Obj::num_moved == 2);
+        assert(Obj::num_move_assigned == 3);
+        assert(v[1].id == ID && v[2].id == 1 && v[5].id == 4);
+        assert(Obj::GetAliveObjectCount() == 6);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        // Ёмкость внешнего буфера выбирает политика роста
+        SmallVector<int, 2, GrowthFactor<3, 2>> v;
+        for (int i = 0; i < 10; ++i) {
+            v.PushBack(i);
+        }
+        assert(v.Capacity() == 13 && v[9] == 9);
+        // Reserve выделяет ровно запрошенную ёмкость, как Vector::Reserve
+        v.Reserve(14);
+        assert(v.Capacity() == 14);
+        v.Reserve(100);
+        assert(v.Capacity() == 100);
+    }
+    {
+        Obj::ResetCounters();
+        SmallVector<Obj, 8> v(3);
+        v[1].id = ID;
+        SmallVector<Obj, 8> moved(std::move(v));
+        assert(moved.Size() == 3 && moved[1].id == ID);
+        assert(v.Size() == 0);
+
+        SmallVector<Obj, 8> copy(moved);
+        copy.Resize(20);
+        assert(!copy.IsInline());
+        assert(copy[1].id == ID);
+        copy.Swap(moved);
+        assert(moved.Size() == 20 && copy.Size() == 3);
+        moved = copy;
+        assert(moved.Size() == 3 && moved[1].id == ID);
+        assert(Obj::GetAliveObjectCount() == 6);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        SmallVector<TestObj, 2> v(2);
+        v.PushBack(v[0]);
+        v.Insert(v.cbegin(), v[2]);
+        assert(std::all_of(v.begin(), v.end(), [](const TestObj& obj) {
+            return obj.IsAlive();
+        }));
+    }
+    {
+        // Исключение при переносе во внешнюю память не должно менять содержимое вектора
+        Obj::ResetCounters();
+        struct ThrowingCopy {
+            ThrowingCopy() = default;
+            ThrowingCopy(const ThrowingCopy& other)
+                : obj(other.obj) {
+            }
+            ThrowingCopy& operator=(const ThrowingCopy&) = default;
+            Obj obj;
+        };
+        SmallVector<ThrowingCopy, 2> v(2);
+        v[1].obj.throw_on_copy = true;
+        try {
+            v.EmplaceBack();
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.IsInline() && v.Size() == 2);
+        assert(Obj::GetAliveObjectCount() == 2);
+    }
+}
+
+void Test11() {
+    {
+        Vector<int, std::allocator<int>, GrowthFactor<3, 2>> v;
+        std::vector<size_t> capacities;
+        for (int i = 0; i < 20; ++i) {
+            v.PushBack(i);
+            if (capacities.empty() || capacities.back() != v.Capacity()) {
+                capacities.push_back(v.Capacity());
+            }
+        }
+        assert((capacities == std::vector<size_t>{1, 2, 3, 4, 6, 9, 13, 19, 28}));
+        v.Insert(v.cbegin(), -1);
+        assert(v.Size() == 21 && v[0] == -1 && v[20] == 19);
+    }
+    {
+        Vector<int, std::allocator<int>, CacheLineMinimumGrowth<>> v;
+        v.EmplaceBack(1);
+        assert(v.Capacity() == kCacheLineSize / sizeof(int));
+        for (int i = 0; i < 16; ++i) {
+            v.EmplaceBack(i);
+        }
+        assert(v.Capacity() == 2 * kCacheLineSize / sizeof(int));
+    }
+    {
+        struct Bytes36 {
+            char data[36];
+        };
+        Vector<Bytes36, std::allocator<Bytes36>, SizeClassGrowth<>> v;
+        for (int i = 0; i < 8; ++i) {
+            v.EmplaceBack();
+        }
+        assert(v.Capacity() == 8);
+        v.EmplaceBack();
+        // 16 элементов по 36 байт = 576 байт, ближайший класс размеров 640 байт вмещает 17 элементов
+        assert(v.Capacity() == 17);
+        assert(SizeClassGrowth<>::RoundUpToSizeClass(1) == 16);
+        assert(SizeClassGrowth<>::RoundUpToSizeClass(129) == 160);
+        assert(SizeClassGrowth<>::RoundUpToSizeClass(1000) == 1024);
+        assert(SizeClassGrowth<>::RoundUpToSizeClass(1100) == 1280);
+    }
+}
+
+template <typename V>
+std::vector<int> ToIds(const V& v) {
+    std::vector<int> ids;
+    for (const auto& item : v) {
+        ids.push_back(item.id);
+    }
+    return ids;
+}
+
+void Test12() {
+    {
+        Vector<int> v;
+        const std::list<int> source{1, 2, 3, 4, 5};
+        v.Append(source.begin(), source.end());
+        assert(v.Size() == 5 && v.Capacity() == 5);
+        v.Insert(v.cbegin() + 1, {10, 11});
+        assert((std::vector<int>(v.begin(), v.end()) == std::vector<int>{1, 10, 11, 2, 3, 4, 5}));
+        v.Reserve(100);
+        v.Insert(v.cbegin(), 3, v[6]);
+        assert((std::vector<int>(v.begin(), v.end()) == std::vector<int>{5, 5, 5, 1, 10, 11, 2, 3, 4, 5}));
+
+        std::istringstream input("7 8 9");
+        auto pos = v.Insert(v.cbegin() + 2, std::istream_iterator<int>(input), std::istream_iterator<int>());
+        assert(pos == v.begin() + 2);
+        assert((std::vector<int>(v.begin(), v.end()) == std::vector<int>{5, 5, 7, 8, 9, 5, 1, 10, 11, 2, 3, 4, 5}));
+        v.Append({});
+        assert(v.Size() == 13);
+    }
+    const size_t SIZE = 10;
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        std::vector<Obj> source(3);
+        for (size_t i = 0; i < source.size(); ++i) {
+            source[i].id = static_cast<int>(i + 1);
+        }
+        const int old_num_copied = Obj::num_copied;
+        v.Insert(v.cbegin() + 2, source.begin(), source.end());
+        assert(v.Size() == SIZE + 3);
+        assert(Obj::num_copied - old_num_copied == 3);
+        assert(Obj::num_moved == SIZE);
+        assert((ToIds(v) == std::vector<int>{0, 0, 1, 2, 3, 0, 0, 0, 0, 0, 0, 0, 0}));
+    }
+    {
+        // Хвост длиннее вставляемого диапазона
+        Obj::ResetCounters();
+        Vector<Obj> v;
+        v.Reserve(SIZE * 2);
+        for (int i = 0; i < static_cast<int>(SIZE); ++i) {
+            v.EmplaceBack(i);
+        }
+        v.Insert(v.cbegin() + 1, 2, Obj{-1});
+        assert((ToIds(v) == std::vector<int>{0, -1, -1, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+        // Хвост короче вставляемого диапазона
+        v.Insert(v.cend() - 1, 3, v[0]);
+        assert((ToIds(v) == std::vector<int>{0, -1, -1, 1, 2, 3, 4, 5, 6, 7, 8, 0, 0, 0, 9}));
+        assert(Obj::GetAliveObjectCount() == 15);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+void Test13() {
+    const size_t SIZE = 100;
+    {
+        Vector<int> v(SIZE, kDefaultInit);
+        assert(v.Size() == SIZE && v.Capacity() == SIZE);
+        std::fill(v.begin(), v.end(), 7);
+        v.ResizeDefaultInit(SIZE / 2);
+        assert(v.Size() == SIZE / 2 && v[0] == 7);
+        v.ResizeDefaultInit(SIZE * 2);
+        assert(v.Size() == SIZE * 2 && v[SIZE / 2 - 1] == 7);
     }
-    ~C() {
-        ++dtor;
+    {
+        using namespace std::literals;
+        const std::string text = "hello, world"s;
+        Vector<char> v;
+        v.PushBack('>');
+        v.ResizeAndOverwrite(SIZE, [&text](char* data, size_t size) {
+            assert(size == SIZE);
+            return static_cast<size_t>(text.copy(data + 1, size - 1) + 1);
+        });
+        assert(v.Size() == text.size() + 1);
+        assert(std::string(v.begin(), v.end()) == ">"s + text);
+    }
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE, kDefaultInit);
+        assert(Obj::num_default_constructed == SIZE);
+        v.ResizeDefaultInit(SIZE + 1);
+        assert(Obj::num_default_constructed == SIZE + 1);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+void Test14() {
+    const size_t SIZE = 10;
+    {
+        Vector<int> v;
+        for (int i = 0; i < static_cast<int>(SIZE); ++i) {
+            v.PushBack(i);
+        }
+        auto pos = v.Erase(v.cbegin() + 2, v.cbegin() + 5);
+        assert(pos == v.begin() + 2 && *pos == 5);
+        assert((std::vector<int>(v.begin(), v.end()) == std::vector<int>{0, 1, 5, 6, 7, 8, 9}));
+        const size_t erased_odd = v.EraseIf([](int x) { return x % 2 == 1; });
+        assert(erased_odd == 4);
+        assert((std::vector<int>(v.begin(), v.end()) == std::vector<int>{0, 6, 8}));
+        v.EraseUnordered(v.cbegin());
+        assert((std::vector<int>(v.begin(), v.end()) == std::vector<int>{8, 6}));
+        v.Erase(v.cbegin(), v.cend());
+        assert(v.Size() == 0 && v.Capacity() == 16);
+    }
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v[i].id = static_cast<int>(i);
+        }
+        v.Erase(v.cbegin() + 1, v.cbegin() + 4);
+        assert(Obj::num_move_assigned == SIZE - 4);
+        assert(Obj::num_destroyed == 3);
+        assert((ToIds(v) == std::vector<int>{0, 4, 5, 6, 7, 8, 9}));
+
+        Obj::ResetCounters();
+        v.EraseUnordered(v.cbegin() + 1);
+        assert(Obj::num_move_assigned == 1 && Obj::num_destroyed == 1);
+        assert((ToIds(v) == std::vector<int>{0, 9, 5, 6, 7, 8}));
+        v.EraseUnordered(v.cend() - 1);
+        assert((ToIds(v) == std::vector<int>{0, 9, 5, 6, 7}));
+
+        Obj::ResetCounters();
+        const size_t erased = v.EraseIf([](const Obj& obj) { return obj.id > 5; });
+        assert(erased == 3);
+        assert((ToIds(v) == std::vector<int>{0, 5}));
+        assert(Obj::num_destroyed == 3);
+    }
+    {
+        Vector<std::unique_ptr<int>> v;
+        for (int i = 0; i < 5; ++i) {
+            v.PushBack(std::make_unique<int>(i));
+        }
+        v.Erase(v.cbegin(), v.cbegin() + 2);
+        assert(v.Size() == 3 && *v[0] == 2 && *v[2] == 4);
+    }
+    {
+        // Удаление пустого диапазона не перемещает элементы сами в себя
+        Vector<std::vector<int>> v;
+        v.PushBack({1, 2, 3});
+        v.PushBack({4, 5});
+        auto pos = v.Erase(v.cbegin(), v.cbegin());
+        assert(pos == v.begin() && v.Size() == 2 && v[0].size() == 3 && v[1].size() == 2);
+        v.Erase(v.cbegin() + 1, v.cbegin() + 1);
+        const size_t erased_empty = v.EraseIf([](const std::vector<int>& x) { return x.empty(); });
+        assert(erased_empty == 0);
+        assert(v[0].size() == 3 && v[1].size() == 2);
+    }
+}
+
+void Test15() {
+    using namespace std::literals;
+    const size_t SIZE = 10;
+    const int ID = 42;
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        v.Reserve(SIZE * 2);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v[i].id = static_cast<int>(i);
+        }
+        const int old_num_moved = Obj::num_moved;
+        v.Insert(v.cbegin() + 1, Obj{ID});
+        // Новый элемент перемещается прямо в свою ячейку, а не через временный объект
+        assert(Obj::num_moved == old_num_moved + 2);
+        assert(Obj::num_move_assigned == SIZE - 2);
+        assert(v[1].id == ID && v[2].id == 1 && v[SIZE].id == SIZE - 1);
+        assert(Obj::GetAliveObjectCount() == SIZE + 1);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        // Аргумент ссылается на элемент, который будет сдвинут
+        Vector<Obj> v;
+        v.Reserve(SIZE);
+        v.EmplaceBack(1, "one"s);
+        v.EmplaceBack(2, "two"s);
+        v.EmplaceBack(3, "three"s);
+        v.Emplace(v.cbegin(), ID, v[1].name);
+        assert(v[0].name == "two"s && v[2].name == "two"s);
+        v.Insert(v.cbegin() + 1, std::move(v[3]));
+        assert(v[1].id == 3);
+        assert((ToIds(v) == std::vector<int>{ID, 3, 1, 2, 3}));
+    }
+    {
+        // Исключение в конструкторе нового элемента не меняет содержимое вектора
+        Obj::ResetCounters();
+        Vector<Obj> v;
+        v.Reserve(SIZE);
+        for (int i = 0; i < 5; ++i) {
+            v.EmplaceBack(i);
+        }
+        Obj::default_construction_throw_countdown = 1;
+        try {
+            v.Emplace(v.cbegin() + 2);
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert((ToIds(v) == std::vector<int>{0, 1, 2, 3, 4}));
+        assert(Obj::GetAliveObjectCount() == 5);
+    }
+}
+
+// Аллокатор, каждый блок которого может дорасти на месте до MAX_ELEMENTS элементов
+template <typename T>
+struct ExpandableAllocator {
+    using value_type = T;
+    static constexpr size_t MAX_ELEMENTS = 1024;
+
+    T* allocate(size_t n) {
+        ++num_allocations;
+        return static_cast<T*>(operator new(std::max(n, MAX_ELEMENTS) * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t /*n*/) noexcept {
+        operator delete(p);
+    }
+
+    bool try_expand(T* /*p*/, size_t /*old_n*/, size_t new_n) noexcept {
+        ++num_expand_calls;
+        return new_n <= MAX_ELEMENTS;
     }
 
-    static void Reset() {
-        def_ctor = 0;
-        copy_ctor = 0;
-        move_ctor = 0;
-        copy_assign = 0;
-        move_assign = 0;
-        dtor = 0;
+    bool operator==(const ExpandableAllocator&) const noexcept {
+        return true;
     }
 
-    inline static size_t def_ctor = 0;
-    inline static size_t copy_ctor = 0;
-    inline static size_t move_ctor = 0;
-    inline static size_t copy_assign = 0;
-    inline static size_t move_assign = 0;
-    inline static size_t dtor = 0;
+    bool operator!=(const ExpandableAllocator&) const noexcept {
+        return false;
+    }
+
+    static inline int num_allocations = 0;
+    static inline int num_expand_calls = 0;
 };
 
-void Dump() {
-    using namespace std;
-    cerr << "Def ctors: "sv << C::def_ctor              //
-         << ", Copy ctors: "sv << C::copy_ctor          //
-         << ", Move ctors: "sv << C::move_ctor          //
-         << ", Copy assignments: "sv << C::copy_assign  //
-         << ", Move assignments: "sv << C::move_assign  //
-         << ", Dtors: "sv << C::dtor << endl;
+void Test16() {
+    const int SIZE = 100'500;
+    {
+        Vector<int, MallocAllocator<int>> v;
+        for (int i = 0; i < SIZE; ++i) {
+            v.PushBack(i);
+        }
+        v.Insert(v.cbegin() + 1, 3, -1);
+        v.Reserve(SIZE * 4);
+        assert(v.Capacity() == SIZE * 4);
+        assert(v.Size() == SIZE + 3);
+        assert(v[0] == 0 && v[1] == -1 && v[3] == -1 && v[4] == 1 && v[SIZE + 2] == SIZE - 1);
+        // Аргумент ссылается на элемент вектора, который переживает реаллокацию
+        v.Resize(v.Capacity());
+        v.PushBack(v[1]);
+        assert(v.Size() == SIZE * 4 + 1 && v[SIZE * 4] == -1);
+    }
+    {
+        using Alloc = ExpandableAllocator<double>;
+        Vector<double, Alloc> v;
+        for (size_t i = 0; i < Alloc::MAX_ELEMENTS; ++i) {
+            v.PushBack(static_cast<double>(i));
+        }
+        assert(Alloc::num_allocations == 1);
+        v.PushBack(-1.0);
+        assert(Alloc::num_allocations == 2);
+        assert(v[0] == 0.0 && v[Alloc::MAX_ELEMENTS - 1] == Alloc::MAX_ELEMENTS - 1.0);
+        assert(v[Alloc::MAX_ELEMENTS] == -1.0);
+    }
 }
 
-void Benchmark() {
-    using namespace std;
-    try {
-        const size_t NUM = 10;
-        C c;
+#ifdef ADVANCED_VECTOR_STATS
+void Test17() {
+    const size_t SIZE = 10;
+    VectorStats& stats = GetVectorStats();
+    {
+        stats.Reset();
+        Vector<Obj> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.EmplaceBack();
+        }
+        // Ёмкость росла 1, 2, 4, 8, 16: пять выделений и четыре переноса 1 + 2 + 4 + 8 элементов
+        assert(stats.allocations == 5);
+        assert(stats.deallocations == 4);
+        assert(stats.reallocations == 4);
+        assert(stats.moved_elements == 15);
+        assert(stats.copied_elements == 0);
+        assert(stats.allocated_bytes == (1 + 2 + 4 + 8 + 16) * sizeof(Obj));
+        assert(stats.deallocated_bytes == (1 + 2 + 4 + 8) * sizeof(Obj));
+
+        v.Emplace(v.cbegin() + 2);
+        v.Erase(v.cbegin(), v.cbegin() + 3);
+        assert(stats.shifting_emplaces == 1);
+        assert(stats.erased_elements == 3);
+    }
+    assert(stats.deallocations == 5 && stats.deallocated_bytes == stats.allocated_bytes);
+    {
+        stats.Reset();
+        Vector<int> v(SIZE);
+        v.Reserve(SIZE * 2);
+        assert(stats.reallocations == 1);
+        assert(stats.relocated_bytes == SIZE * sizeof(int));
+        assert(stats.moved_elements == 0);
+    }
+    {
+        // realloc растит один и тот же блок: выделение одно, остальное - прирост байт
+        stats.Reset();
         {
-            C::Reset();
-            vector<C> v(NUM);
-            Dump();
-            v.push_back(c);
+            Vector<int, MallocAllocator<int>> v;
+            for (size_t i = 0; i < SIZE; ++i) {
+                v.PushBack(static_cast<int>(i));
+            }
+            assert(stats.allocations == 1);
+            assert(stats.deallocations == 0);
+            assert(stats.reallocations == 4);
+            assert(stats.allocated_bytes == sizeof(int));
+            assert(stats.allocated_bytes + stats.resized_bytes == v.Capacity() * sizeof(int));
+            assert(stats.relocated_bytes == 0 && stats.moved_elements == 0);
         }
-        Dump();
-    } catch (...) {
+        // Освобождается весь выросший на месте блок
+        assert(stats.deallocations == 1);
+        assert(stats.deallocated_bytes == stats.allocated_bytes + stats.resized_bytes);
     }
-    try {
-        const size_t NUM = 10;
-        C c;
+    {
+        static size_t num_reallocation_events = 0;
+        SetVectorStatsCallback([](VectorEvent event, size_t /*amount*/) noexcept {
+            if (event == VectorEvent::kReallocate) {
+                ++num_reallocation_events;
+            }
+        });
+        Vector<int> v;
+        for (int i = 0; i < 5; ++i) {
+            v.PushBack(i);
+        }
+        SetVectorStatsCallback(nullptr);
+        v.PushBack(5);
+        assert(num_reallocation_events == 3);
+    }
+}
+#endif
+
+void Test18() {
+    const size_t SIZE = 100;
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        v.Reserve(SIZE * 4);
+        v[SIZE - 1].id = 42;
+        const bool shrunk_at_four = v.ShrinkIfWasteful(4.0);
+        assert(!shrunk_at_four);
+        const bool shrunk_at_three = v.ShrinkIfWasteful(3.0);
+        assert(shrunk_at_three);
+        assert(v.Capacity() == SIZE && v.Size() == SIZE);
+        assert(v[SIZE - 1].id == 42);
+        assert(Obj::num_copied == 0);
+
+        v.Resize(SIZE / 2);
+        v.ShrinkToFit();
+        assert(v.Capacity() == SIZE / 2);
+
+        v.Clear();
+        assert(v.Size() == 0 && v.Capacity() == SIZE / 2);
+        assert(Obj::GetAliveObjectCount() == 0);
+        v.ShrinkToFit();
+        assert(v.Capacity() == 0 && v.Data() == nullptr);
+        v.PushBack(Obj{1});
+        assert(v.Size() == 1 && v[0].id == 1);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        Vector<int> v(SIZE);
+        v.Reserve(SIZE * 10);
+        v[0] = 7;
+        v.ShrinkToFit();
+        assert(v.Capacity() == SIZE && v[0] == 7);
+    }
+}
+
+void Test19() {
+    const int NUM_THREADS = 8;
+    const int PER_THREAD = 20'000;
+    {
+        ConcurrentVector<std::string> v;
+        const size_t first = v.PushBack("first");
+        const std::string* first_address = &v[first];
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < NUM_THREADS; ++t) {
+            threads.emplace_back([&v, t, first_address] {
+                for (int i = 0; i < PER_THREAD; ++i) {
+                    const size_t index = v.EmplaceBack(std::to_string(t * PER_THREAD + i));
+                    assert(v[index] == std::to_string(t * PER_THREAD + i));
+                    // Уже добавленные элементы не перемещаются
+                    assert(&v[0] == first_address);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        assert(v.Size() == NUM_THREADS * PER_THREAD + 1);
+
+        Vector<std::string> flat = v.ToVector();
+        assert(flat.Size() == v.Size());
+        assert(flat[0] == "first");
+        std::vector<int> values;
+        for (size_t i = 1; i < flat.Size(); ++i) {
+            values.push_back(std::stoi(flat[i]));
+        }
+        std::sort(values.begin(), values.end());
+        for (int i = 0; i < NUM_THREADS * PER_THREAD; ++i) {
+            assert(values[i] == i);
+        }
+
+        Vector<std::string> taken = v.TakeVector();
+        assert(taken.Size() == v.Size() && taken[0] == "first");
+    }
+    {
+        Obj::ResetCounters();
         {
-            cerr << "Vector:"sv << endl;
-            C::Reset();
-            Vector<C> v(NUM);
-            Dump();
-            v.PushBack(c);
+            ConcurrentVector<Obj> v;
+            v.EmplaceBack(1);
+            Obj::default_construction_throw_countdown = 1;
+            try {
+                v.EmplaceBack();
+                assert(false && "Exception is expected");
+            } catch (const std::runtime_error&) {
+            }
+            v.EmplaceBack(3);
+            Vector<Obj> flat = v.ToVector();
+            assert((ToIds(flat) == std::vector<int>{1, 3}));
         }
-        Dump();
-    } catch (...) {
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        struct Throwing {
+            operator int() const {
+                throw std::runtime_error("Oops");
+            }
+        };
+        ConcurrentVector<int> v;
+        for (int i = 0; i < 100; ++i) {
+            if (i % 7 == 3) {
+                try {
+                    v.EmplaceBack(Throwing{});
+                    assert(false && "Exception is expected");
+                } catch (const std::runtime_error&) {
+                }
+            } else {
+                v.EmplaceBack(i);
+            }
+        }
+        // Копирование из константного вектора с пропущенными ячейками ничего в нём не меняет
+        const ConcurrentVector<int>& view = v;
+        const auto check = [&view] {
+            const Vector<int> flat = view.ToVector();
+            assert(flat.Size() == 86 && flat[3] == 4 && flat[85] == 99);
+        };
+        std::thread reader(check);
+        check();
+        reader.join();
+    }
+}
+
+#ifdef ADVANCED_VECTOR_PARALLEL
+void Test20() {
+    ParallelSettings& settings = GetParallelSettings();
+    const ParallelSettings old_settings = settings;
+    settings.threshold = 8;
+    settings.num_chunks = 4;
+
+    // Параллельные потоки с настоящими std::thread
+    {
+        Vector<std::string> v(100);
+        for (size_t i = 0; i < v.Size(); ++i) {
+            v[i] = std::to_string(i);
+        }
+        Vector<std::string> copy(v);
+        Vector<std::string> assigned(50);
+        assigned.Reserve(200);
+        assigned = v;
+        for (size_t i = 0; i < v.Size(); ++i) {
+            assert(copy[i] == std::to_string(i));
+            assert(assigned[i] == std::to_string(i));
+        }
+    }
+
+    // Части выполняются по очереди, чтобы счётчики Obj не требовали синхронизации
+    Vector<size_t> executed_tasks;
+    settings.executor = [&executed_tasks](size_t num_tasks, const std::function<void(size_t)>& task) {
+        executed_tasks.PushBack(num_tasks);
+        for (size_t i = num_tasks; i-- > 0;) {
+            task(i);
+        }
+    };
+    {
+        Obj::ResetCounters();
+        {
+            Vector<Obj> v(20);
+            assert(Obj::num_default_constructed == 20);
+            Vector<Obj> copy(v);
+            assert(Obj::num_copied == 20);
+            Vector<Obj> assigned(10);
+            assigned.Reserve(20);
+            assigned = v;
+            assert(Obj::num_assigned == 10 && Obj::num_copied == 30);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+        assert(executed_tasks.Size() > 0);
+        for (size_t num_tasks : executed_tasks) {
+            assert(num_tasks == settings.num_chunks);
+        }
+    }
+    {
+        // Короткие векторы обрабатываются последовательно
+        executed_tasks.Clear();
+        Vector<Obj> v(5);
+        assert(executed_tasks.Size() == 0);
+    }
+    {
+        // Исключение в одной из частей: успешно сконструированные части разрушаются
+        Obj::ResetCounters();
+        Obj::default_construction_throw_countdown = 3;
+        try {
+            Vector<Obj> v(20);
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(Obj::num_default_constructed > 0);
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+
+    settings = old_settings;
+}
+#endif
+
+void Test21() {
+    const size_t SIZE = 1'000'000;
+    {
+        MmapVector<uint64_t, AlwaysMmapPolicy> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(i);
+        }
+        assert(reinterpret_cast<uintptr_t>(&v[0]) % 4096 == 0);
+        for (size_t i = 0; i < SIZE; ++i) {
+            assert(v[i] == i);
+        }
+        v.ShrinkToFit();
+        assert(v.Capacity() == SIZE && v[SIZE - 1] == SIZE - 1);
+    }
+    {
+        // Буфер растёт через порог: сначала malloc, затем mmap
+        using Policy = MmapPolicy<size_t{1} << 16, false, true>;
+        MmapVector<int, Policy> v;
+        for (int i = 0; i < static_cast<int>(SIZE); ++i) {
+            v.PushBack(i);
+        }
+        assert(v.Size() == SIZE && v[0] == 0 && v[SIZE / 2] == static_cast<int>(SIZE / 2));
+        MmapVector<int, Policy> copy(v);
+        v.Clear();
+        v.ShrinkToFit();
+        assert(copy.Size() == SIZE && copy[SIZE - 1] == static_cast<int>(SIZE - 1));
+    }
+    {
+        // Элементы, не переносимые побайтово, переносятся конструктором перемещения
+        MmapVector<std::string, AlwaysMmapPolicy> v;
+        for (int i = 0; i < 1000; ++i) {
+            v.PushBack(std::to_string(i));
+        }
+        v.Insert(v.cbegin(), "first");
+        assert(v.Size() == 1001 && v[0] == "first" && v[1000] == "999");
+    }
+}
+
+void Test22() {
+    char path_template[] = "/tmp/advanced_vector_test_XXXXXX";
+    const int fd = mkstemp(path_template);
+    assert(fd >= 0);
+    close(fd);
+    const std::string path = path_template;
+
+    struct Point {
+        double x;
+        double y;
+    };
+    const size_t SIZE = 100'000;
+    {
+        MappedVector<Point> v(path);
+        assert(v.Size() == 0 && v.Capacity() == 0);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack({static_cast<double>(i), -static_cast<double>(i)});
+        }
+        v.PushBack(v[0]);
+        v.PopBack();
+        // Аргументы EmplaceBack ссылаются на элемент, который переедет при росте отображения
+        while (v.Size() != v.Capacity()) {
+            v.PushBack(v[0]);
+        }
+        const size_t full = v.Size();
+        v.EmplaceBack(v[1]);
+        assert(v.Capacity() > full && v[full].x == 1.0 && v[full].y == -1.0);
+        v.Resize(SIZE);
+        v.Sync();
+    }
+    {
+        MappedVector<Point> v(path);
+        assert(v.Size() == SIZE && v.Capacity() >= SIZE);
+        for (size_t i = 0; i < SIZE; ++i) {
+            assert(v[i].x == static_cast<double>(i) && v[i].y == -static_cast<double>(i));
+        }
+        v.Resize(SIZE / 2);
+        v.Resize(SIZE / 2 + 1);
+        assert(v[SIZE / 2].x == 0.0);
+    }
+    {
+        MappedVector<Point> v(path);
+        assert(v.Size() == SIZE / 2 + 1 && v[SIZE / 2 - 1].x == static_cast<double>(SIZE / 2 - 1));
+        MappedVector<Point> moved(std::move(v));
+        assert(moved.Size() == SIZE / 2 + 1);
+        // Перемещённый вектор пуст и не обращается к чужому отображению
+        assert(v.Size() == 0 && v.Capacity() == 0 && v.begin() == v.end());
+        v.Clear();
+    }
+    {
+        // Файл хранит элементы другого размера
+        try {
+            MappedVector<int> v(path);
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+    }
+    {
+        try {
+            MappedVector<int> v("/nonexistent_dir/vector");
+            assert(false && "Exception is expected");
+        } catch (const std::system_error& e) {
+            assert(e.code() == std::errc::no_such_file_or_directory);
+        }
+    }
+    unlink(path.c_str());
+}
+
+void Test23() {
+    {
+        Arena arena(1 << 20);
+        Vector<int, ArenaAllocator<int>> v{ArenaAllocator<int>(arena)};
+        v.PushBack(0);
+        const int* data = &v[0];
+        for (int i = 1; i < 100'000; ++i) {
+            v.PushBack(i);
+        }
+        // Последний буфер арены расширяется на месте, пока хватает блока
+        assert(&v[0] == data && v[99'999] == 99'999);
+
+        // Вектор, выделенный позже, не даёт расширить на месте предыдущий
+        Vector<double, ArenaAllocator<double>> other(10, ArenaAllocator<double>(arena));
+        v.Resize(v.Capacity() + 1);
+        assert(&v[0] != data && v[0] == 0 && v[99'999] == 99'999 && v[v.Size() - 1] == 0);
+        other.PushBack(1.5);
+        assert(other[10] == 1.5);
+
+        Vector<int, ArenaAllocator<int>> copy(v);
+        assert(copy.GetAllocator() == v.GetAllocator() && copy[99'999] == 99'999);
+    }
+    {
+        Arena arena(64);
+        Vector<int, ArenaAllocator<int>> v{ArenaAllocator<int>(arena)};
+        v.Reserve(4);
+        const int* data = v.Data();
+        v.Reserve(8);
+        assert(v.Data() == data);
+        v.Reserve(1000);
+        assert(v.Data() != data);
+    }
+    {
+        PoolResource pool;
+        using Alloc = PoolAllocator<std::string>;
+        {
+            Vector<std::string, Alloc> v{Alloc(pool)};
+            for (int i = 0; i < 1000; ++i) {
+                v.PushBack(std::to_string(i));
+            }
+            v.Erase(v.begin(), v.begin() + 500);
+            assert(v.Size() == 500 && v[0] == "500" && v[499] == "999");
+        }
+
+        // Освобождённые буферы переиспользуются
+        void* p = pool.Allocate(100, alignof(int));
+        pool.Deallocate(p, 100, alignof(int));
+        void* reused = pool.Allocate(120, alignof(int));
+        assert(reused == p);
+        const bool expanded = pool.TryExpand(p, 120, 128, alignof(int));
+        const bool expanded_past_class = pool.TryExpand(p, 120, 129, alignof(int));
+        assert(expanded && !expanded_past_class);
+        pool.Deallocate(p, 128, alignof(int));
+
+        Vector<int, PoolAllocator<int>> v(3, PoolAllocator<int>(pool));
+        const int* data = &v[0];
+        v.Reserve(4);
+        v.PushBack(1);
+        assert(&v[0] == data && v[3] == 1);
+
+        void* large = pool.Allocate(PoolResource::kMaxSize + 1, alignof(int));
+        pool.Deallocate(large, PoolResource::kMaxSize + 1, alignof(int));
+    }
+    {
+        // Буферы с расширенным выравниванием выделяются мимо пула и не растут на месте
+        struct alignas(64) Wide {
+            int value = 0;
+        };
+        PoolResource pool;
+        Vector<Wide, PoolAllocator<Wide>> v{PoolAllocator<Wide>(pool)};
+        v.Reserve(3);
+        const Wide* data = v.Data();
+        v.Reserve(4);
+        assert(v.Data() != data);
+        for (int i = 0; i < 4; ++i) {
+            v.PushBack(Wide{i});
+        }
+        assert(v.Size() == 4 && v[3].value == 3);
+        const bool expanded = pool.TryExpand(v.Data(), 4 * sizeof(Wide), 5 * sizeof(Wide), alignof(Wide));
+        assert(!expanded);
+    }
+}
+
+#if __cplusplus >= 202002L
+// Вектор строится и разрушается во время компиляции, наружу выходит только результат
+constexpr int SumOfSquares(int n) {
+    Vector<int> v;
+    for (int i = 0; i < n; ++i) {
+        v.PushBack(i * i);
+    }
+    v.Insert(v.cbegin(), 3, -1);
+    v.Insert(v.cbegin() + 1, v[4]);
+    v.Erase(v.cbegin(), v.cbegin() + 4);
+    v.EraseIf([](int x) {
+        return x % 2 != 0;
+    });
+    Vector<int> copy(v);
+    copy.Resize(copy.Size() + 2);
+    copy.ShrinkToFit();
+    int sum = 0;
+    for (int x : copy) {
+        sum += x;
+    }
+    return sum;
+}
+
+struct ConstexprPoint {
+    constexpr ConstexprPoint(int x, int y)
+        : x(x)
+        , y(y) {
+    }
+    constexpr ConstexprPoint(const ConstexprPoint&) = default;
+    constexpr ConstexprPoint& operator=(const ConstexprPoint&) = default;
+    constexpr ~ConstexprPoint() {
+    }
+    int x;
+    int y;
+};
+
+constexpr int BuildPoints() {
+    Vector<ConstexprPoint> points;
+    points.Reserve(2);
+    for (int i = 0; i < 10; ++i) {
+        points.EmplaceBack(i, -i);
+    }
+    points.Emplace(points.cbegin() + 5, points[0]);
+    Vector<ConstexprPoint> other;
+    other = points;
+    other.PopBack();
+    return other[5].x + other[9].y + static_cast<int>(other.Size());
+}
+
+void Test24() {
+    static_assert(SumOfSquares(10) == 0 + 4 + 16 + 36 + 64);
+    static_assert(BuildPoints() == 0 - 8 + 10);
+    assert(SumOfSquares(10) == 120);
+    assert(BuildPoints() == 2);
+}
+#endif
+
+void Test25() {
+    static_assert(std::is_trivially_copyable_v<StaticVector<int, 4>>);
+    static_assert(!std::is_trivially_copyable_v<StaticVector<std::string, 4>>);
+    static_assert(StaticVector<int, 4>::Capacity() == 4);
+    {
+        StaticVector<int, 4> v;
+        const bool pushed = v.TryEmplaceBack(1) && v.TryEmplaceBack(3);
+        assert(pushed);
+        v.Insert(v.cbegin() + 1, 2);
+        v.Emplace(v.cbegin(), v[2]);
+        const bool overflowed = !v.TryEmplaceBack(5);
+        assert(overflowed);
+        try {
+            v.PushBack(5);
+            assert(false && "Exception is expected");
+        } catch (const std::length_error&) {
+        }
+        assert(v.Size() == 4 && v[0] == 3 && v[1] == 1 && v[2] == 2 && v[3] == 3);
+
+        // Тривиально копируемый StaticVector можно копировать побайтово
+        StaticVector<int, 4> copy;
+        std::memcpy(static_cast<void*>(&copy), &v, sizeof(v));
+        assert(copy.Size() == 4 && copy[3] == 3);
+        copy.Erase(copy.cbegin(), copy.cbegin() + 2);
+        assert(copy.Size() == 2 && copy[0] == 2 && copy[1] == 3);
+    }
+    {
+        Obj::ResetCounters();
+        {
+            StaticVector<Obj, 5> v(2);
+            assert(Obj::num_default_constructed == 2);
+            v.EmplaceBack(1);
+            v.Emplace(v.cbegin(), 2, "two");
+            StaticVector<Obj, 5> copy(v);
+            assert(Obj::num_copied == 4 && copy[0].id == 2 && copy[3].id == 1);
+            StaticVector<Obj, 5> moved(std::move(copy));
+            copy = v;
+            moved.Erase(moved.cbegin());
+            v = moved;
+            assert(v.Size() == 3 && v[2].id == 1);
+            v = std::move(copy);
+            assert(v.Size() == 4 && v[0].id == 2);
+            v.Resize(1);
+            v.PopBack();
+            assert(v.Size() == 0);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        StaticVector<std::string, 4> v;
+        v.EmplaceBack("one");
+        v.EmplaceBack("two");
+        const auto pos = v.Erase(v.cbegin(), v.cbegin());
+        assert(pos == v.begin());
+        assert(v.Size() == 2 && v[0] == "one" && v[1] == "two");
+    }
+    {
+        // Emplace в середину конструирует элемент сразу на месте, без временного объекта
+        Obj::ResetCounters();
+        {
+            StaticVector<Obj, 4> v;
+            v.EmplaceBack(1);
+            v.EmplaceBack(2);
+            v.EmplaceBack(3);
+            v.Emplace(v.cbegin(), 7, "seven");
+            assert(Obj::num_constructed_with_id_and_name == 1 && Obj::num_moved == 1);
+            assert(Obj::num_move_assigned == 2);
+            assert(v[0].id == 7 && v[0].name == "seven" && v[1].id == 1 && v[3].id == 3);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        StaticVector<std::string, 8> v;
+        v.EmplaceBack("a");
+        v.EmplaceBack("d");
+        auto pos = v.Insert(v.cbegin() + 1, {"b", "c"});
+        assert(pos == v.begin() + 1);
+        pos = v.Insert(v.cend(), 2, v[0]);
+        assert(pos == v.begin() + 4);
+        const std::string tail[] = {"y", "z"};
+        v.Insert(v.cbegin(), std::begin(tail), std::end(tail));
+        assert(v.Size() == 8);
+        assert(v[0] == "y" && v[1] == "z" && v[2] == "a" && v[3] == "b" && v[4] == "c" && v[5] == "d");
+        assert(v[6] == "a" && v[7] == "a");
+        try {
+            v.Insert(v.cbegin(), 1, std::string("x"));
+            assert(false && "Exception is expected");
+        } catch (const std::length_error&) {
+        }
+        assert(v.Size() == 8 && v[0] == "y");
+    }
+    {
+        StaticVector<int, 6> v;
+        v.PushBack(1);
+        v.PushBack(5);
+        std::istringstream input("2 3 4");
+        const auto pos = v.Insert(v.cbegin() + 1, std::istream_iterator<int>(input), std::istream_iterator<int>());
+        assert(pos == v.begin() + 1);
+        assert(v.Size() == 5 && v[1] == 2 && v[2] == 3 && v[3] == 4 && v[4] == 5);
+    }
+}
+
+// Тип без конструктора перемещения, копирование которого может выбросить исключение
+struct CopyOnly {
+    explicit CopyOnly(int id)
+        : id(id) {
+    }
+    CopyOnly(const CopyOnly& other)
+        : id(other.id) {
+        if (copy_throw_countdown > 0 && --copy_throw_countdown == 0) {
+            throw std::runtime_error("Oops");
+        }
+    }
+    CopyOnly& operator=(const CopyOnly&) = default;
+
+    int id;
+    static inline int copy_throw_countdown = 0;
+};
+
+void Test26() {
+    {
+        SoAVector<int, double, std::string> v;
+        for (int i = 0; i < 100; ++i) {
+            v.EmplaceBack(i, i * 0.5, std::to_string(i));
+        }
+        assert(v.Size() == 100 && v.Capacity() >= 100);
+
+        double sum = 0;
+        for (double x : v.Column<1>()) {
+            sum += x;
+        }
+        assert(sum == 99 * 100 / 2 * 0.5);
+
+        auto [id, value, name] = v[10];
+        assert(id == 10 && value == 5.0 && name == "10");
+        name = "ten";
+        std::get<0>(v[11]) = -11;
+        assert(v.Column<2>()[10] == "ten" && v.Column<0>()[11] == -11);
+
+        // Аргументы ссылаются на поля вектора, которые переживают реаллокацию
+        v.Reserve(v.Size());
+        v.EmplaceBack(std::get<0>(v[0]), std::get<1>(v[1]), std::get<2>(v[10]));
+        assert(std::get<2>(v[100]) == "ten" && std::get<1>(v[100]) == 0.5);
+
+        v.Erase(0, 10);
+        v.Erase(0);
+        v.Erase(5, 5);
+        assert(v.Size() == 90 && std::get<0>(v[0]) == -11 && std::get<2>(v[89]) == "ten");
+
+        const SoAVector<int, double, std::string> copy(v);
+        v.Resize(5);
+        v.Resize(7);
+        assert(v.Size() == 7 && std::get<2>(v[6]).empty() && copy.Size() == 90);
+        assert(std::get<2>(copy[0]) == "11" && copy.Column<0>().Size() == 90);
+    }
+    {
+        // Столбец, который при росте копируется с исключением, не даёт испортить остальные столбцы
+        Obj::ResetCounters();
+        {
+            SoAVector<Obj, CopyOnly> v;
+            v.Reserve(4);
+            for (int i = 0; i < 4; ++i) {
+                v.EmplaceBack(i, CopyOnly(i));
+            }
+            const int moved = Obj::num_moved;
+            CopyOnly::copy_throw_countdown = 3;
+            try {
+                v.EmplaceBack(4, CopyOnly(4));
+                assert(false && "Exception is expected");
+            } catch (const std::runtime_error&) {
+            }
+            assert(Obj::num_moved == moved && v.Size() == 4 && v.Capacity() == 4);
+            for (int i = 0; i < 4; ++i) {
+                assert(std::get<0>(v[i]).id == i && std::get<1>(v[i]).id == i);
+            }
+            v.EmplaceBack(4, CopyOnly(4));
+            assert(v.Size() == 5 && std::get<0>(v[4]).id == 4 && std::get<1>(v[0]).id == 0);
+
+            SoAVector<Obj, CopyOnly> other;
+            other = v;
+            other = std::move(v);
+            assert(other.Size() == 5 && v.Size() == 0);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        // Политика роста задаётся так же, как у Vector
+        BasicSoAVector<GrowthFactor<3, 2>, int, char> v;
+        std::vector<size_t> capacities;
+        for (int i = 0; i < 20; ++i) {
+            v.EmplaceBack(i, 'a');
+            if (capacities.empty() || capacities.back() != v.Capacity()) {
+                capacities.push_back(v.Capacity());
+            }
+        }
+        assert((capacities == std::vector<size_t>{1, 2, 3, 4, 6, 9, 13, 19, 28}));
+
+        // Размером элемента для политики считается размер строки
+        BasicSoAVector<CacheLineMinimumGrowth<>, int, int> rows;
+        rows.EmplaceBack(1, 2);
+        assert(rows.Capacity() == kCacheLineSize / (2 * sizeof(int)));
+    }
+}
+
+// Сравнивает значения побитово, чтобы отличать -0.0 от 0.0 и учитывать NaN
+template <typename T>
+bool BitwiseEqual(T lhs, T rhs) {
+    return std::memcmp(&lhs, &rhs, sizeof(T)) == 0;
+}
+
+// Сверяет выбранные во время выполнения реализации со скалярными на векторе v
+template <typename T>
+void CheckSimdKernels(const Vector<T>& v) {
+    using Scalar = ScalarKernels<T>;
+    const T* data = v.Data();
+    const size_t n = v.Size();
+
+    for (size_t i = 0; i < n; i += 7) {
+        const T value = data[i];
+        const size_t expected = std::find(v.begin(), v.end(), value) - v.begin();
+        assert(FindValue(v, value) == expected && Scalar::Find(data, n, value) == expected);
+        assert(CountValue(v, value) == static_cast<size_t>(std::count(v.begin(), v.end(), value)));
+    }
+    assert(FindValue(v, T(12345)) == n && CountValue(v, T(12345)) == 0);
+    assert(BitwiseEqual(SumValues(v), Scalar::Sum(data, n)));
+
+    if (n > 0) {
+        assert(BitwiseEqual(MinValue(v), Scalar::Min(data, n)));
+        assert(BitwiseEqual(MaxValue(v), Scalar::Max(data, n)));
+    }
+
+    for (Compare cmp : {Compare::kLess, Compare::kLessEqual, Compare::kGreater, Compare::kGreaterEqual,
+                        Compare::kEqual, Compare::kNotEqual}) {
+        const T value = n > 0 ? data[n / 2] : T(0);
+        Vector<T> expected;
+        for (const T& x : v) {
+            if (CompareValues(x, cmp, value)) {
+                expected.PushBack(x);
+            }
+        }
+        Vector<T> filtered(v);
+        assert(KeepIf(filtered, cmp, value) == n - expected.Size());
+        assert(std::equal(filtered.begin(), filtered.end(), expected.begin(), expected.end(), BitwiseEqual<T>));
+    }
+}
+
+void Test27() {
+    uint32_t seed = 42;
+    const auto next = [&seed] {
+        seed = seed * 1664525 + 1013904223;
+        return seed >> 8;
+    };
+
+    for (size_t n : {0, 1, 3, 7, 8, 9, 15, 16, 17, 31, 64, 100, 1000, 4099}) {
+        Vector<int32_t> ints;
+        Vector<float> floats;
+        Vector<double> doubles;
+        for (size_t i = 0; i < n; ++i) {
+            // Небольшой диапазон значений даёт повторы для поиска и подсчёта
+            const uint32_t r = next();
+            float f = static_cast<float>(r % 1000) / 7.0f - 50.0f;
+            double d = static_cast<double>(r % 1000) / 3.0 - 150.0;
+            if (r % 23 == 0) {
+                f = -0.0f;
+                d = std::nan("");
+            } else if (r % 29 == 0) {
+                f = std::nanf("");
+                d = -0.0;
+            }
+            ints.PushBack(static_cast<int32_t>(r % 201) - 100 + (r % 17 == 0 ? INT32_MIN / 2 : 0));
+            floats.PushBack(f);
+            doubles.PushBack(d);
+        }
+        CheckSimdKernels(ints);
+        CheckSimdKernels(floats);
+        CheckSimdKernels(doubles);
+    }
+    {
+        // Целые суммируются без переполнения 32-битного типа
+        Vector<int32_t> v(100);
+        std::fill(v.begin(), v.end(), INT32_MAX);
+        assert(SumValues(v) == int64_t{INT32_MAX} * 100);
+        assert(MinValue(v) == INT32_MAX && MaxValue(v) == INT32_MAX);
+        v[37] = INT32_MIN;
+        assert(MinValue(v) == INT32_MIN && FindValue(v, INT32_MIN) == 37);
+    }
+    {
+        Vector<float> v;
+        for (int i = 0; i < 50; ++i) {
+            v.PushBack(static_cast<float>(i));
+        }
+        assert(KeepIf(v, Compare::kGreaterEqual, 10) == 10);
+        assert(v.Size() == 40 && v[0] == 10.0f && v[39] == 49.0f);
+        assert(KeepIf(v, Compare::kLess, 0) == 40 && v.Size() == 0);
+    }
+}
+
+void Test28() {
+    {
+        SegmentedVector<int, 8> v;
+        const int* first = &v.EmplaceBack(0);
+        for (int i = 1; i < 100; ++i) {
+            // Аргумент ссылается на элемент вектора, который не переезжает при росте
+            v.PushBack(v[i - 1] + 1);
+        }
+        assert(&v[0] == first && v.Size() == 100 && v.Capacity() == 104);
+        assert(v.ChunkCount() == 13 && v.Chunk(12).Size() == 4 && v.Chunk(3)[0] == 24);
+
+        int expected = 0;
+        for (size_t i = 0; i < v.ChunkCount(); ++i) {
+            for (int x : v.Chunk(i)) {
+                assert(x == expected++);
+            }
+        }
+        assert(std::is_sorted(v.begin(), v.end()) && v.end() - v.begin() == 100);
+        assert(*std::lower_bound(v.cbegin(), v.cend(), 57) == 57 && v.begin()[42] == 42);
+
+        const Vector<int> flat = v.Flatten();
+        assert(flat.Size() == 100 && std::equal(flat.begin(), flat.end(), v.begin()));
+
+        v.Resize(10);
+        v.ShrinkToFit();
+        assert(v.Size() == 10 && v.Capacity() == 16 && &v[0] == first);
+        v.Resize(20);
+        assert(v[9] == 9 && v[19] == 0);
+        v.PopBack();
+        v.Clear();
+        assert(v.Size() == 0 && v.Capacity() == 24);
+    }
+    {
+        Obj::ResetCounters();
+        {
+            SegmentedVector<Obj, 4> v;
+            for (int i = 0; i < 10; ++i) {
+                v.EmplaceBack(i);
+            }
+            assert(Obj::num_moved == 0 && Obj::num_copied == 0);
+
+            SegmentedVector<Obj, 4> copy(v);
+            assert(copy.Size() == 10 && copy[9].id == 9);
+
+            // Исключения при копировании и при росте не меняют вектор
+            v[6].throw_on_copy = true;
+            try {
+                copy = v;
+                assert(false && "Exception is expected");
+            } catch (const std::runtime_error&) {
+            }
+            v[6].throw_on_copy = false;
+            assert(copy.Size() == 10);
+            Obj::default_construction_throw_countdown = 6;
+            try {
+                copy.Resize(20);
+                assert(false && "Exception is expected");
+            } catch (const std::runtime_error&) {
+            }
+            assert(copy.Size() == 10 && copy[9].id == 9);
+
+            const Vector<Obj> flat = std::move(v).Flatten();
+            assert(flat.Size() == 10 && flat[5].id == 5 && v.Size() == 0 && v.Capacity() == 0);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+}
+
+void Test29() {
+    {
+        Vector<int> data;
+        for (int i = 0; i < 10; ++i) {
+            data.PushBack(i);
+        }
+        const CowVector<int> original(std::move(data));
+        CowVector<int> copy = original;
+        assert(original.UseCount() == 2 && copy.cbegin() == original.cbegin());
+
+        // Чтение через константную ссылку не копирует буфер
+        const CowVector<int>& view = copy;
+        assert(view[3] == 3 && view.Size() == 10 && original.UseCount() == 2);
+
+        // Неконстантный объект тоже читается без копирования
+        assert(copy[3] == 3 && *copy.begin() == 0 && original.UseCount() == 2);
+
+        (*copy.Mutable())[3] = 30;
+        assert(original.UseCount() == 1 && copy.UseCount() == 1);
+        assert(original[3] == 3 && copy[3] == 30);
+
+        // Аргумент ссылается на элемент общего буфера, который отделяется при добавлении
+        CowVector<int> other = original;
+        other.PushBack(original[9]);
+        other.Insert(other.cbegin(), original[5]);
+        assert(other.Size() == 12 && other[0] == 5 && other[11] == 9 && original.Size() == 10);
+
+        CowVector<int> erased = original;
+        erased.Erase(erased.cbegin() + 2, erased.cbegin() + 5);
+        assert(erased.Size() == 7 && erased[2] == 5 && original[2] == 2);
+
+        CowVector<int> cleared = original;
+        cleared.Clear();
+        assert(cleared.Size() == 0 && cleared.UseCount() == 0 && original.UseCount() == 1);
+        cleared.EmplaceBack(1);
+        cleared.Resize(3);
+        assert(cleared.Size() == 3 && cleared[0] == 1 && cleared[2] == 0);
+    }
+    {
+        Obj::ResetCounters();
+        {
+            CowVector<Obj> v(5);
+            CowVector<Obj> copies[10];
+            for (CowVector<Obj>& copy : copies) {
+                copy = v;
+            }
+            assert(Obj::num_copied == 0 && v.UseCount() == 11);
+            v.Mutable()->EmplaceBack(5);
+            assert(Obj::num_copied == 5 && v.Size() == 6 && copies[0].UseCount() == 10);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        // Копии разделяют буфер между потоками, каждый поток изменяет свою копию
+        const CowVector<int> table(Vector<int>(1000));
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&table, t] {
+                for (int i = 0; i < 100; ++i) {
+                    CowVector<int> snapshot = table;
+                    assert(snapshot.Size() == 1000);
+                    if (i % 10 == 0) {
+                        (*snapshot.Mutable())[0] = t;
+                        assert(snapshot[0] == t && table[0] == 0);
+                    }
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        assert(table.UseCount() == 1 && table[0] == 0);
+    }
+    {
+        // Пока объект из Mutable жив, копии получают собственный буфер
+        CowVector<int> a;
+        a.PushBack(1);
+        {
+            const auto scope = a.Mutable();
+            Vector<int>& data = *scope;
+            CowVector<int> b = a;
+            data[0] = 42;
+            data.PushBack(2);
+            assert(b.Size() == 1 && b[0] == 1 && a[0] == 42 && a.UseCount() == 1);
+        }
+
+        // После разрушения объекта буфер снова разделяется
+        CowVector<int> c = a;
+        assert(a.UseCount() == 2 && c.cbegin() == a.cbegin() && c[1] == 2);
+
+        // Вектор, заполненный через PushBack и EmplaceBack, разделяет буфер с копиями
+        CowVector<int> d;
+        for (int i = 0; i < 1000; ++i) {
+            d.PushBack(i);
+        }
+        const int& last = d.EmplaceBack(1000);
+        CowVector<int> e(d);
+        assert(d.UseCount() == 2 && e.cbegin() == d.cbegin() && last == 1000);
+
+        // Изменяющие методы отделяют буфер и возвращают константные итераторы
+        const CowVector<int>::const_iterator it = e.Insert(e.cbegin() + 1, -1);
+        assert(*it == -1 && e[1] == -1 && d[1] == 1 && d.UseCount() == 1);
+        const auto next = e.Erase(e.cbegin());
+        assert(*next == -1 && e.Size() == 1001);
+    }
+}
+
+// Кодек строк: длина и байты строки
+struct StringCodec {
+    void Encode(const std::string& value, Vector<char>& out) const {
+        const uint32_t size = static_cast<uint32_t>(value.size());
+        const char* size_bytes = reinterpret_cast<const char*>(&size);
+        out.Append(size_bytes, size_bytes + sizeof(size));
+        out.Append(value.begin(), value.end());
+    }
+
+    std::string Decode(const char*& data, const char* end) const {
+        uint32_t size;
+        if (static_cast<size_t>(end - data) < sizeof(size)) {
+            throw std::runtime_error("Truncated string");
+        }
+        std::memcpy(&size, data, sizeof(size));
+        data += sizeof(size);
+        if (static_cast<size_t>(end - data) < size) {
+            throw std::runtime_error("Truncated string");
+        }
+        std::string value(data, size);
+        data += size;
+        return value;
+    }
+};
+
+void Test30() {
+    struct Point {
+        double x;
+        int32_t id;
+    };
+    {
+        Vector<Point> points;
+        for (int i = 0; i < 1000; ++i) {
+            points.PushBack({i * 0.5, i});
+        }
+        std::stringstream stream;
+        WriteTo(stream, points);
+        assert(stream.str().size() == sizeof(VectorFileHeader) + points.Size() * sizeof(Point));
+
+        Vector<Point> loaded(3);
+        ReadFrom(stream, loaded);
+        assert(loaded.Size() == 1000 && loaded.Capacity() == 1000);
+        assert(loaded[999].x == 499.5 && loaded[999].id == 999);
+
+        // Повреждённые данные не меняют вектор-приёмник
+        const std::string bytes = stream.str();
+        const auto expect_failure = [&loaded](const std::string& data) {
+            std::stringstream in(data);
+            try {
+                ReadFrom(in, loaded);
+                assert(false && "Exception is expected");
+            } catch (const std::exception&) {
+            }
+            assert(loaded.Size() == 1000 && loaded[10].id == 10);
+        };
+        expect_failure(bytes.substr(0, bytes.size() - 1));
+        expect_failure(bytes.substr(0, 10));
+        std::string other_order = bytes;
+        std::swap(other_order[offsetof(VectorFileHeader, byte_order)], other_order[offsetof(VectorFileHeader, byte_order) + 3]);
+        expect_failure(other_order);
+        std::stringstream ints;
+        WriteTo(ints, Vector<int32_t>(5));
+        expect_failure(ints.str());
+
+        // Заголовок обещает больше элементов, чем есть данных: память под них заранее не выделяется
+        std::string oversized = bytes;
+        const uint64_t huge_size = uint64_t{1} << 40;
+        std::memcpy(&oversized[offsetof(VectorFileHeader, size)], &huge_size, sizeof(huge_size));
+        expect_failure(oversized);
+
+        Vector<Point> empty;
+        std::stringstream empty_stream;
+        WriteTo(empty_stream, empty);
+        ReadFrom(empty_stream, loaded);
+        assert(loaded.Size() == 0);
+    }
+    {
+        Vector<std::string> words;
+        for (int i = 0; i < 20000; ++i) {
+            words.PushBack(std::string(i % 13, 'a' + i % 26) + std::to_string(i));
+        }
+        std::stringstream stream;
+        WriteTo(stream, words, StringCodec{});
+        Vector<std::string> loaded;
+        ReadFrom(stream, loaded, StringCodec{});
+        assert(loaded.Size() == words.Size() && std::equal(loaded.begin(), loaded.end(), words.begin()));
+
+        std::stringstream raw;
+        WriteTo(raw, Vector<int>(2));
+        try {
+            ReadFrom(raw, loaded, StringCodec{});
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(loaded.Size() == words.Size());
+
+        // Повреждённые размеры в заголовке и в заголовке блока
+        const std::string bytes = stream.str();
+        const auto expect_failure = [&loaded, &words](const std::string& data) {
+            std::stringstream in(data);
+            try {
+                ReadFrom(in, loaded, StringCodec{});
+                assert(false && "Exception is expected");
+            } catch (const std::exception&) {
+            }
+            assert(loaded.Size() == words.Size());
+        };
+        std::string oversized = bytes;
+        const uint64_t huge_size = uint64_t{1} << 40;
+        std::memcpy(&oversized[offsetof(VectorFileHeader, size)], &huge_size, sizeof(huge_size));
+        expect_failure(oversized);
+        std::string huge_chunk = bytes;
+        std::memcpy(&huge_chunk[sizeof(VectorFileHeader) + sizeof(uint64_t)], &huge_size, sizeof(huge_size));
+        expect_failure(huge_chunk);
+    }
+    {
+        char path_template[] = "/tmp/advanced_vector_io_XXXXXX";
+        const int fd = mkstemp(path_template);
+        assert(fd >= 0);
+        Vector<int> numbers;
+        for (int i = 0; i < 100000; ++i) {
+            numbers.PushBack(i * 3);
+        }
+        WriteTo(fd, numbers);
+        lseek(fd, 0, SEEK_SET);
+        Vector<int> loaded;
+        ReadFrom(fd, loaded);
+        assert(loaded.Size() == numbers.Size() && loaded[99999] == 299997);
+        try {
+            ReadFrom(fd, loaded);
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        close(fd);
+        unlink(path_template);
+    }
+    {
+        // Источники с известной длиной сообщают, сколько байт осталось, не меняя позицию
+        std::stringstream stream("0123456789");
+        VectorIstreamSource stream_source(stream);
+        char head[4];
+        stream_source.Read(head, sizeof(head));
+        assert(stream_source.Remaining() == 6u && stream.tellg() == 4);
+
+        int pipe_fds[2];
+        assert(pipe(pipe_fds) == 0);
+        assert(!VectorFdSource(pipe_fds[0]).Remaining().has_value());
+        close(pipe_fds[0]);
+        close(pipe_fds[1]);
+
+        // Файл больше kVectorIoMaxUpfrontBytes читается целиком
+        char path_template[] = "/tmp/advanced_vector_io_XXXXXX";
+        const int fd = mkstemp(path_template);
+        assert(fd >= 0);
+        const size_t count = 2 * kVectorIoMaxUpfrontBytes / sizeof(uint64_t) + 3;
+        Vector<uint64_t> numbers(count, kDefaultInit);
+        for (size_t i = 0; i < count; ++i) {
+            numbers[i] = i * 7;
+        }
+        WriteTo(fd, numbers);
+        lseek(fd, 0, SEEK_SET);
+        VectorFdSource file_source(fd);
+        assert(file_source.Remaining() == sizeof(VectorFileHeader) + count * sizeof(uint64_t));
+        Vector<uint64_t> loaded;
+        ReadFrom(fd, loaded);
+        assert(loaded.Size() == count && loaded.Capacity() == count && loaded[count - 1] == (count - 1) * 7);
+        assert(file_source.Remaining() == 0u);
+        close(fd);
+        unlink(path_template);
+    }
+}
+
+void Test31() {
+    {
+        Vector<int> v(3);
+        v.At(2) = 5;
+        assert(std::as_const(v).At(2) == 5);
+        try {
+            v.At(3);
+            assert(false && "Exception is expected");
+        } catch (const std::out_of_range&) {
+        }
+    }
+#ifdef ADVANCED_VECTOR_HARDENED
+    {
+        Vector<int> v(4);
+        Vector<int>::iterator it = v.begin() + 1;
+        Vector<int>::const_iterator end = v.cend();
+        assert(it.IsDereferenceable() && !end.IsDereferenceable() && end.IsValid());
+
+        // Без реаллокации итераторы остаются действительными
+        v.Reserve(4);
+        v.PopBack();
+        assert(it.IsDereferenceable() && !end.IsValid());
+
+        v.Reserve(100);
+        assert(!it.IsValid() && v.begin().IsValid());
+        it = v.begin();
+        v.Resize(v.Capacity());
+        assert(it.IsDereferenceable());
+        v.PushBack(1);
+        assert(!it.IsValid());
+
+        Vector<int> other(2);
+        it = v.begin();
+        Vector<int>::iterator other_it = other.begin();
+        v.Swap(other);
+        assert(!it.IsValid() && !other_it.IsValid());
+        v.ShrinkToFit();
+        assert(v.begin().IsDereferenceable() && std::distance(v.begin(), v.end()) == 2);
+    }
+    {
+        // Обращение по итератору после реаллокации аварийно завершает процесс
+        const pid_t pid = fork();
+        if (pid == 0) {
+            std::freopen("/dev/null", "w", stderr);
+            Vector<int> v(1);
+            const auto it = v.begin();
+            v.Reserve(1000);
+            [[maybe_unused]] volatile int x = *it;
+            std::_Exit(0);
+        }
+        int status = 0;
+        waitpid(pid, &status, 0);
+        assert(WIFSIGNALED(status) && WTERMSIG(status) == SIGABRT);
+    }
+#else
+    static_assert(std::is_same_v<Vector<int>::iterator, int*> && std::is_same_v<Vector<int>::const_iterator, const int*>);
+    static_assert(sizeof(Vector<int>) == sizeof(int*) + 2 * sizeof(size_t));
+#endif
+}
+
+void Test32() {
+    const int nodes = NumaNodeCount();
+    assert(nodes >= 1);
+    const size_t page_ints = static_cast<size_t>(sysconf(_SC_PAGESIZE)) / sizeof(int);
+    {
+        // Ни одна страница ещё не выделена: размещение неизвестно
+        NumaVector<int> v(NumaAllocator<int>(NumaPolicy{NumaPlacement::kBind, 0}));
+        v.Reserve(4 * page_ints);
+        const Vector<size_t> untouched = NumaPagesPerNode(v.Data(), v.Capacity() * sizeof(int));
+        assert(untouched.Size() == static_cast<size_t>(nodes));
+        assert(std::count(untouched.begin(), untouched.end(), 0U) == nodes);
+
+        v.Resize(4 * page_ints);
+        const int node = NumaNodeOf(v.Data());
+        assert(node == -1 || node == 0);
+        v.Resize(64 * page_ints);  // рост через mremap сохраняет политику
+        v[v.Size() - 1] = 7;
+        assert(v[0] == 0 && v[v.Size() - 1] == 7);
+    }
+    {
+        NumaVector<double> v(NumaAllocator<double>(NumaPolicy{NumaPlacement::kInterleave}));
+        v.Resize(16 * page_ints);
+        const Vector<size_t> pages = NumaPagesPerNode(v.Data(), v.Size() * sizeof(double));
+        size_t total = 0;
+        for (size_t count : pages) {
+            total += count;
+        }
+        assert(total <= 32 + 1);
+        NumaVector<double> copy = v;
+        assert(copy.GetAllocator() == v.GetAllocator() && copy.Size() == v.Size());
+        assert(NumaAllocator<int>(NumaPolicy{NumaPlacement::kBind, 0}) != NumaAllocator<int>(NumaPolicy{NumaPlacement::kBind, 1}));
+    }
+    {
+        const size_t size = 10 * page_ints + 3;
+        NumaVector<int> v = MakeFirstTouchVector<int>(size, 4);
+        assert(v.Size() == size && v.GetAllocator().GetPolicy().placement == NumaPlacement::kFirstTouch);
+        assert(std::all_of(v.begin(), v.end(), [](int x) {
+            return x == 0;
+        }));
+        assert(MakeFirstTouchVector<int>(0).Size() == 0);
+    }
+    {
+        std::atomic<size_t> done = 0;
+        NumaFirstTouchExecutor()(8, [&done](size_t) {
+            ++done;
+        });
+        assert(done == 8);
+    }
+}
+
+// Применяет правки к std::vector по одной, от последней к первой
+template <typename T>
+std::vector<T> ApplyEditsNaively(std::vector<T> v, const Vector<VectorEdit<T>>& edits) {
+    for (size_t i = edits.Size(); i-- > 0;) {
+        const VectorEdit<T>& edit = edits[i];
+        v.erase(v.begin() + edit.position, v.begin() + edit.position + edit.erase_count);
+        v.insert(v.begin() + edit.position, edit.values, edit.values + edit.insert_count);
+    }
+    return v;
+}
+
+template <typename T, typename MakeValue>
+void CheckRandomEdits(MakeValue make_value) {
+    unsigned seed = 12345;
+    const auto next = [&seed](unsigned bound) {
+        seed = seed * 1103515245 + 12345;
+        return (seed >> 16) % bound;
+    };
+    for (int round = 0; round < 200; ++round) {
+        std::vector<T> expected;
+        Vector<T> v;
+        v.Reserve(next(2) == 0 ? 0 : 64);
+        const size_t size = next(40);
+        for (size_t i = 0; i < size; ++i) {
+            expected.push_back(make_value(static_cast<int>(i)));
+            v.PushBack(expected.back());
+        }
+
+        std::vector<T> values;
+        for (int i = 0; i < 60; ++i) {
+            values.push_back(make_value(1000 + i));
+        }
+        Vector<VectorEdit<T>> edits;
+        size_t position = 0;
+        size_t next_value = 0;
+        while (position <= size && next(4) != 0) {
+            position += next(4);
+            if (position > size) {
+                break;
+            }
+            const size_t erase_count = std::min<size_t>(next(3), size - position);
+            const size_t insert_count = std::min<size_t>(next(4), values.size() - next_value);
+            edits.PushBack({position, erase_count, values.data() + next_value, insert_count});
+            next_value += insert_count;
+            position += erase_count;
+        }
+
+        expected = ApplyEditsNaively(expected, edits);
+        v.ApplyEdits(edits);
+        assert(std::equal(v.begin(), v.end(), expected.begin(), expected.end()));
+    }
+}
+
+void Test33() {
+    {
+        Vector<int> v;
+        for (int i = 0; i < 10; ++i) {
+            v.PushBack(i);
+        }
+        const int values[] = {100, 101};
+        v.ApplyEdits({VectorEdit<int>::Insert(0, -1), VectorEdit<int>::Erase(2, 3), VectorEdit<int>::Insert(7, values, 2),
+            VectorEdit<int>::Erase(9), VectorEdit<int>::Insert(10, 42)});
+        const std::vector<int> expected = {-1, 0, 1, 5, 6, 100, 101, 7, 8, 42};
+        assert(std::equal(v.begin(), v.end(), expected.begin(), expected.end()));
+        v.ApplyEdits(Vector<VectorEdit<int>>());
+        assert(v.Size() == expected.size());
+    }
+    CheckRandomEdits<int>([](int i) {
+        return i;
+    });
+    CheckRandomEdits<std::string>([](int i) {
+        return std::string(20, static_cast<char>('a' + i % 26)) + std::to_string(i);
+    });
+
+    Obj::ResetCounters();
+    {
+        // При нехватке ёмкости исключение оставляет вектор нетронутым
+        Vector<Obj> v;
+        v.Reserve(4);
+        for (int i = 0; i < 4; ++i) {
+            v.EmplaceBack(i);
+        }
+        Obj values[3];
+        values[2].throw_on_copy = true;
+        try {
+            v.ApplyEdits({VectorEdit<Obj>::Insert(1, values, 2), VectorEdit<Obj>::Erase(2), VectorEdit<Obj>::Insert(3, values[2])});
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == 4 && v.Capacity() == 4);
+        for (int i = 0; i < 4; ++i) {
+            assert(v[i].id == i);
+        }
+        assert(Obj::GetAliveObjectCount() == 4 + 3);
+
+        // На месте вектор остаётся корректным
+        v.Reserve(16);
+        try {
+            v.ApplyEdits({VectorEdit<Obj>::Insert(1, values, 2), VectorEdit<Obj>::Erase(2), VectorEdit<Obj>::Insert(3, values[2])});
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(v.Size()) + 3);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+void Test34() {
+    {
+        FlatSet<int> set = {5, 1, 3, 1, 5};
+        assert(set.Size() == 3 && *set.begin() == 1 && set.Contains(3) && !set.Contains(2));
+        const bool inserted = set.Insert(2).second;
+        const bool inserted_again = set.Insert(2).second;
+        assert(inserted && !inserted_again && set.Size() == 4);
+        assert(*set.LowerBound(4) == 5 && set.UpperBound(5) == set.end() && set.Find(4) == set.end());
+        set.InsertRange({10, 0, 4, 3, 7, 10});
+        const std::vector<int> expected = {0, 1, 2, 3, 4, 5, 7, 10};
+        assert(std::equal(set.begin(), set.end(), expected.begin(), expected.end()));
+        const size_t erased_keys = set.EraseKeys({1, 2, 3, 8, 10});
+        assert(erased_keys == 4 && set.Size() == 4);
+        const size_t erased_zero = set.Erase(0);
+        const size_t erased_zero_again = set.Erase(0);
+        const auto after_first = set.Erase(set.begin());
+        assert(erased_zero == 1 && erased_zero_again == 0 && *after_first == 5);
+
+        Vector<std::string> words;
+        for (const char* word : {"pear", "apple", "fig", "apple"}) {
+            words.PushBack(word);
+        }
+        FlatSet<std::string, std::greater<>> reversed(std::move(words));
+        assert(reversed.Size() == 3 && *reversed.begin() == "pear");
+        FlatSet<std::string, std::greater<>> other = {"kiwi", "fig"};
+        reversed.Merge(other);
+        assert(reversed.Size() == 4 && reversed.Keys()[1] == "kiwi");
+        const Vector<std::string> keys = std::move(reversed).Extract();
+        assert(keys.Size() == 4 && keys[3] == "apple");
+    }
+    {
+        FlatMap<int, std::string> map = {{3, "c"}, {1, "a"}, {3, "x"}, {2, "b"}};
+        assert(map.Size() == 3 && map.At(3) == "c" && map.Keys()[0] == 1 && map.Values()[2] == "c");
+        try {
+            map.At(4);
+            assert(false && "Exception is expected");
+        } catch (const std::out_of_range&) {
+        }
+        map[4] = "d";
+        const bool emplaced = map.TryEmplace(4, "z").second;
+        assert(!emplaced && map.At(4) == "d");
+        const bool assigned_new = map.InsertOrAssign(4, "e").second;
+        assert(!assigned_new && map.At(4) == "e");
+        const bool inserted = map.Insert({0, "zero"}).second;
+        assert(inserted && map.Find(0).Value() == "zero");
+
+        std::string joined;
+        for (auto [key, value] : map) {
+            joined += std::to_string(key) + value;
+            value += "!";
+        }
+        assert(joined == "0zero1a2b3c4e" && map.At(1) == "a!");
+
+        // Итератор произвольного доступа: двоичный поиск по диапазону и арифметика за O(1)
+        static_assert(std::is_same_v<std::iterator_traits<FlatMap<int, std::string>::const_iterator>::iterator_category,
+                                     std::random_access_iterator_tag>);
+        const auto found = std::partition_point(map.cbegin(), map.cend(), [](auto entry) {
+            return entry.first < 3;
+        });
+        assert(found.Key() == 3 && found - map.cbegin() == 3 && std::distance(map.begin(), map.end()) == 5);
+        auto it = map.begin() + 4;
+        it -= 2;
+        assert(it[1].second == "c!" && (2 + it).Key() == 4 && (it - 1).Key() == 1);
+        assert(map.cbegin() < it && it <= map.end() && map.end() > it && !(it >= map.end()));
+
+        const std::vector<std::pair<int, std::string>> batch = {{9, "i"}, {2, "no"}, {5, "f"}, {6, "g"}, {9, "no"}};
+        map.InsertRange(batch.begin(), batch.end());
+        assert(map.Size() == 8 && map.At(2) == "b!" && map.At(9) == "i" && map.At(5) == "f");
+        const size_t erased_keys = map.EraseKeys({5, 6, 7, 0});
+        assert(erased_keys == 3 && map.Size() == 5 && !map.Contains(6));
+        const size_t erased_nine = map.Erase(9);
+        const auto after_one = map.Erase(map.Find(1));
+        assert(erased_nine == 1 && after_one.Key() == 2);
+        assert(map.Size() == 3);
+    }
+    {
+        // Пакетные операции совпадают с std::map
+        unsigned seed = 7;
+        const auto next = [&seed](unsigned bound) {
+            seed = seed * 1103515245 + 12345;
+            return static_cast<int>((seed >> 16) % bound);
+        };
+        FlatMap<int, int> map;
+        FlatSet<int> set;
+        std::map<int, int> expected;
+        for (int round = 0; round < 100; ++round) {
+            std::vector<std::pair<int, int>> added;
+            for (int i = next(30); i > 0; --i) {
+                added.emplace_back(next(500), round);
+            }
+            map.InsertRange(added.begin(), added.end());
+            expected.insert(added.begin(), added.end());
+            for (const auto& [key, value] : added) {
+                set.Insert(key);
+            }
+
+            std::vector<int> removed;
+            for (int i = next(20); i > 0; --i) {
+                removed.push_back(next(500));
+            }
+            size_t expected_count = 0;
+            for (int key : std::set<int>(removed.begin(), removed.end())) {
+                expected_count += expected.erase(key);
+            }
+            const size_t map_erased = map.EraseKeys(removed.begin(), removed.end());
+            const size_t set_erased = set.EraseKeys(removed.begin(), removed.end());
+            assert(map_erased == expected_count && set_erased == expected_count);
+
+            assert(map.Size() == expected.size() && set.Size() == expected.size());
+            auto it = expected.begin();
+            for (auto [key, value] : std::as_const(map)) {
+                assert(key == it->first && value == it->second);
+                ++it;
+            }
+            assert(std::equal(set.Keys().begin(), set.Keys().end(), map.Keys().begin(), map.Keys().end()));
+        }
+    }
+}
+
+void Test35() {
+    Obj::ResetCounters();
+    {
+        Vector<Obj> v;
+        v.Reserve(8);
+        v.EmplaceBack(1);
+        v.EmplaceBack(2);
+        const Obj* buffer = v.Data();
+        RawMemory<Obj> storage = v.ReleaseStorage();
+        assert(v.Size() == 0 && v.Capacity() == 0 && Obj::GetAliveObjectCount() == 0);
+        assert(storage.GetAddress() == buffer && storage.Capacity() == 8);
+
+        Vector<Obj> other(3);
+        other.AdoptStorage(std::move(storage));
+        assert(other.Size() == 0 && other.Capacity() == 8 && other.Data() == buffer);
+        assert(storage.Capacity() == 0 && Obj::GetAliveObjectCount() == 0);
+        other.EmplaceBack(3);
+        assert(other.Data() == buffer && other[0].id == 3);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        VectorPool<int> pool(2, 1024 * sizeof(int));
+        Vector<int> v = pool.Acquire(10);
+        assert(v.Size() == 0 && v.Capacity() >= 10 && pool.Size() == 0);
+        v.Resize(100);
+        const int* buffer = v.Data();
+        pool.Release(v);
+        assert(v.Capacity() == 0 && pool.Size() == 1);
+
+        Vector<int> reused = pool.Acquire();
+        assert(reused.Size() == 0 && reused.Capacity() >= 100 && reused.Data() == buffer && pool.Size() == 0);
+
+        // Слишком большие буферы и буферы сверх max_buffers не сохраняются
+        pool.Release(Vector<int>(2000));
+        pool.Release(Vector<int>(1));
+        pool.Release(Vector<int>(2));
+        pool.Release(Vector<int>(3));
+        assert(pool.Size() == 2);
+        const Vector<int> first = pool.Acquire(2);
+        assert(first.Capacity() == 2 && pool.Size() == 1);
+        // Буфер меньше запрошенного остаётся в пуле, а вектор получает новый буфер
+        const Vector<int> second = pool.Acquire(2);
+        assert(second.Capacity() == 2 && pool.Size() == 1);
+        const Vector<int> small = pool.Acquire();
+        assert(small.Capacity() == 1 && pool.Size() == 0);
+        pool.Release(std::move(reused));
+        pool.Clear();
+        assert(pool.Size() == 0);
+    }
+    {
+        VectorPool<int>& pool = VectorPool<int>::Local();
+        pool.Release(pool.Acquire(128));
+#ifdef ADVANCED_VECTOR_STATS
+        VectorStats& stats = GetVectorStats();
+        stats.Reset();
+#endif
+        for (int message = 0; message < 100; ++message) {
+            Vector<int> v = pool.Acquire();
+            for (int i = 0; i < 100; ++i) {
+                v.PushBack(message + i);
+            }
+            assert(v.Size() == 100 && v[99] == message + 99);
+            pool.Release(v);
+        }
+#ifdef ADVANCED_VECTOR_STATS
+        assert(stats.allocations == 0 && stats.deallocations == 0);
+#endif
+
+        std::thread([] {
+            assert(VectorPool<int>::Local().Size() == 0);
+        }).join();
+        pool.Clear();
     }
 }
 
@@ -646,7 +2702,41 @@ int main() {
         Test4();
         Test5();
         Test6();
-        Benchmark();
+        Test7();
+        Test8();
+        Test9();
+        Test10();
+        Test11();
+        Test12();
+        Test13();
+        Test14();
+        Test15();
+        Test16();
+#ifdef ADVANCED_VECTOR_STATS
+        Test17();
+#endif
+        Test18();
+        Test19();
+#ifdef ADVANCED_VECTOR_PARALLEL
+        Test20();
+#endif
+        Test21();
+        Test22();
+        Test23();
+#if __cplusplus >= 202002L
+        Test24();
+#endif
+        Test25();
+        Test26();
+        Test27();
+        Test28();
+        Test29();
+        Test30();
+        Test31();
+        Test32();
+        Test33();
+        Test34();
+        Test35();
     } catch (const std::exception& e) {
         std::cerr << e.what() << std::endl;
     }
@@ -0,0 +1,333 @@
+#pragma once
+#include "vector.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Вектор, буфер которого - отображённый в память файл. Элементы сохраняются в файле без
+// сериализации, поэтому вектор, открытый на уже существующем файле, сразу готов к работе:
+// его элементы подгружаются ядром по мере обращения к ним.
+//
+// Файл начинается с заголовка kHeaderSize байт (сигнатура, версия формата, sizeof(T), размер и ёмкость),
+// за которым идут элементы. Файл можно открывать только как MappedVector того же типа T на машине
+// с тем же порядком байт. Изменения попадают в файл при закрытии вектора или при вызове Sync
+template <typename T>
+class MappedVector
+{
+    static_assert(std::is_trivially_copyable_v<T>, "MappedVector stores elements as raw bytes");
+
+public:
+
+    static constexpr size_t kHeaderSize = 64;
+    static constexpr uint32_t kVersion = 1;
+
+    static_assert(alignof(T) <= kHeaderSize, "Elements must be aligned within the file mapping");
+
+    // Открывает файл path, создавая пустой вектор, если файла нет или он пуст.
+    // Выбрасывает std::system_error при ошибке ввода-вывода и std::runtime_error,
+    // если файл не является MappedVector<T>
+    explicit MappedVector(const std::string& path)
+    {
+        fd_ = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd_ < 0)
+        {
+            ThrowSystemError("cannot open ", path);
+        }
+
+        try
+        {
+            struct stat st;
+            if (fstat(fd_, &st) != 0)
+            {
+                ThrowSystemError("cannot stat ", path);
+            }
+
+            if (st.st_size == 0)
+            {
+                ResizeFile(kHeaderSize);
+                Map(kHeaderSize);
+                *GetHeader() = Header{kMagic, kVersion, sizeof(T), 0, 0};
+            }
+            else
+            {
+                const size_t file_size = static_cast<size_t>(st.st_size);
+                if (file_size < kHeaderSize)
+                {
+                    throw std::runtime_error("MappedVector: " + path + " is too short");
+                }
+                Map(file_size);
+                const Header& header = *GetHeader();
+                if (header.magic != kMagic || header.version != kVersion || header.element_size != sizeof(T)
+                    || header.size > header.capacity || header.capacity > (file_size - kHeaderSize) / sizeof(T))
+                {
+                    throw std::runtime_error("MappedVector: " + path + " does not hold a compatible vector");
+                }
+            }
+        }
+        catch (...)
+        {
+            Close();
+            throw;
+        }
+    }
+
+    MappedVector(const MappedVector&) = delete;
+    MappedVector& operator=(const MappedVector&) = delete;
+
+    MappedVector(MappedVector&& other) noexcept
+        : fd_(std::exchange(other.fd_, -1))
+        , mapping_(std::exchange(other.mapping_, nullptr))
+        , mapping_size_(std::exchange(other.mapping_size_, 0))
+    {
+    }
+
+    MappedVector& operator=(MappedVector&& rhs) noexcept
+    {
+        if (this != &rhs)
+        {
+            Close();
+            fd_ = std::exchange(rhs.fd_, -1);
+            mapping_ = std::exchange(rhs.mapping_, nullptr);
+            mapping_size_ = std::exchange(rhs.mapping_size_, 0);
+        }
+        return *this;
+    }
+
+    ~MappedVector()
+    {
+        Close();
+    }
+
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    iterator begin() noexcept
+    {
+        return Data();
+    }
+
+    iterator end() noexcept
+    {
+        return Data() + Size();
+    }
+
+    const_iterator begin() const noexcept
+    {
+        return Data();
+    }
+
+    const_iterator end() const noexcept
+    {
+        return Data() + Size();
+    }
+
+    const_iterator cbegin() const noexcept
+    {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept
+    {
+        return end();
+    }
+
+    // Перемещённый вектор не владеет отображением и считается пустым
+    size_t Size() const noexcept
+    {
+        return mapping_ != nullptr ? static_cast<size_t>(GetHeader()->size) : 0;
+    }
+
+    size_t Capacity() const noexcept
+    {
+        return mapping_ != nullptr ? static_cast<size_t>(GetHeader()->capacity) : 0;
+    }
+
+    const T& operator[](size_t index) const noexcept
+    {
+        return const_cast<MappedVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept
+    {
+        assert(index < Size());
+        return Data()[index];
+    }
+
+    // Увеличивает файл и его отображение. Адреса элементов при этом могут измениться
+    void Reserve(size_t new_capacity)
+    {
+        if (new_capacity <= Capacity())
+        {
+            return;
+        }
+        if (new_capacity > (static_cast<size_t>(-1) - kHeaderSize) / sizeof(T))
+        {
+            throw std::length_error("MappedVector: capacity is too large");
+        }
+
+        // Файл занимает целое число страниц, поэтому остаток последней страницы тоже идёт в ёмкость
+        const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        const size_t file_size = (kHeaderSize + new_capacity * sizeof(T) + page_size - 1) / page_size * page_size;
+        ResizeFile(file_size);
+        Map(file_size);
+        GetHeader()->capacity = (file_size - kHeaderSize) / sizeof(T);
+    }
+
+    void Resize(size_t new_size)
+    {
+        const size_t size = Size();
+        if (new_size > size)
+        {
+            Reserve(new_size);
+            std::uninitialized_value_construct_n(Data() + size, new_size - size);
+        }
+        if (new_size != size)
+        {
+            GetHeader()->size = new_size;
+        }
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args)
+    {
+        const size_t size = Size();
+        T* place = nullptr;
+        if (size == Capacity())
+        {
+            // Аргументы могут ссылаться на элементы этого вектора, которые переедут при росте
+            // отображения, поэтому новый элемент создаётся до Reserve
+            T tmp(std::forward<Args>(args)...);
+            Reserve(DoublingGrowth::NextCapacity(Capacity(), size + 1, sizeof(T)));
+            place = new (Data() + size) T(std::move(tmp));
+        }
+        else
+        {
+            place = new (Data() + size) T(std::forward<Args>(args)...);
+        }
+        GetHeader()->size = size + 1;
+        return *place;
+    }
+
+    void PushBack(const T& value)
+    {
+        EmplaceBack(value);
+    }
+
+    void PopBack() noexcept
+    {
+        assert(Size() > 0);
+        --GetHeader()->size;
+    }
+
+    void Clear() noexcept
+    {
+        if (mapping_ != nullptr)
+        {
+            GetHeader()->size = 0;
+        }
+    }
+
+    // Записывает изменения в файл. При async == true только ставит запись в очередь
+    void Sync(bool async = false)
+    {
+        if (msync(mapping_, mapping_size_, async ? MS_ASYNC : MS_SYNC) != 0)
+        {
+            ThrowSystemError("msync failed");
+        }
+    }
+
+private:
+
+    static constexpr uint64_t kMagic = 0x50414d4345564441;  // "ADVECMAP"
+
+    struct Header
+    {
+        uint64_t magic;
+        uint32_t version;
+        uint32_t element_size;
+        uint64_t size;
+        uint64_t capacity;
+    };
+
+    static_assert(sizeof(Header) <= kHeaderSize);
+
+    // errno запоминается до того, как его может испортить формирование сообщения
+    [[noreturn]] static void ThrowSystemError(const char* what, const std::string& path = {})
+    {
+        const int error = errno;
+        throw std::system_error(error, std::generic_category(), std::string("MappedVector: ") + what + path);
+    }
+
+    Header* GetHeader() noexcept
+    {
+        return static_cast<Header*>(mapping_);
+    }
+
+    const Header* GetHeader() const noexcept
+    {
+        return static_cast<const Header*>(mapping_);
+    }
+
+    T* Data() noexcept
+    {
+        return mapping_ != nullptr ? reinterpret_cast<T*>(static_cast<char*>(mapping_) + kHeaderSize) : nullptr;
+    }
+
+    const T* Data() const noexcept
+    {
+        return const_cast<MappedVector&>(*this).Data();
+    }
+
+    // Изменяет длину файла
+    void ResizeFile(size_t file_size)
+    {
+        if (ftruncate(fd_, static_cast<off_t>(file_size)) != 0)
+        {
+            ThrowSystemError("cannot resize file");
+        }
+    }
+
+    // Отображает первые size байт файла. Новое отображение создаётся до того, как снимается старое,
+    // поэтому при ошибке вектор остаётся в прежнем состоянии
+    void Map(size_t size)
+    {
+        void* mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (mapping == MAP_FAILED)
+        {
+            ThrowSystemError("cannot map file");
+        }
+        if (mapping_ != nullptr)
+        {
+            munmap(mapping_, mapping_size_);
+        }
+        mapping_ = mapping;
+        mapping_size_ = size;
+    }
+
+    void Close() noexcept
+    {
+        if (mapping_ != nullptr)
+        {
+            munmap(mapping_, mapping_size_);
+            mapping_ = nullptr;
+            mapping_size_ = 0;
+        }
+        if (fd_ >= 0)
+        {
+            close(fd_);
+            fd_ = -1;
+        }
+    }
+
+    int fd_ = -1;
+    void* mapping_ = nullptr;
+    size_t mapping_size_ = 0;
+};
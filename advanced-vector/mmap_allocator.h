@@ -0,0 +1,187 @@
+#pragma once
+#include "vector.h"
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+// Параметры MmapAllocator:
+//   Threshold - буферы от Threshold байт отображаются через mmap, меньшие выделяются через malloc
+//       (0 - всегда mmap);
+//   HugePages - отображать буферы огромными страницами: сначала MAP_HUGETLB (требует заранее
+//       зарезервированных страниц), иначе обычное отображение с madvise(MADV_HUGEPAGE);
+//   Populate - заранее отобразить все страницы буфера (MAP_POPULATE), чтобы первое обращение
+//       к элементам не вызывало page fault
+template <size_t Threshold, bool HugePages = true, bool Populate = false>
+struct MmapPolicy {
+    static constexpr size_t kThreshold = Threshold;
+    static constexpr bool kHugePages = HugePages;
+    static constexpr bool kPopulate = Populate;
+};
+
+inline constexpr size_t kHugePageSize = size_t{2} << 20;
+
+// Буферы меньше одной огромной страницы выгоднее брать из обычной кучи
+using DefaultMmapPolicy = MmapPolicy<kHugePageSize>;
+using AlwaysMmapPolicy = MmapPolicy<0>;
+
+// Аллокатор для больших векторов, отображающий буферы напрямую через mmap и освобождающий
+// их через munmap. Vector с этим аллокатором растёт через mremap, не копируя элементы
+template <typename T, typename Policy = DefaultMmapPolicy>
+class MmapAllocator {
+    static_assert(alignof(T) <= alignof(std::max_align_t),
+                  "MmapAllocator serves buffers below Policy::kThreshold with malloc/realloc, "
+                  "which only guarantee alignof(std::max_align_t)");
+
+public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    template <typename U>
+    struct rebind {
+        using other = MmapAllocator<U, Policy>;
+    };
+
+    MmapAllocator() noexcept = default;
+
+    template <typename U>
+    MmapAllocator(const MmapAllocator<U, Policy>&) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        const size_t bytes = CheckedBytes(n);
+        if (!IsMapped(bytes)) {
+            return static_cast<T*>(Malloc(bytes));
+        }
+        return static_cast<T*>(Map(MappedLength(bytes)));
+    }
+
+    void deallocate(T* buf, size_t n) noexcept {
+        const size_t bytes = n * sizeof(T);
+        if (!IsMapped(bytes)) {
+            std::free(buf);
+        } else {
+            munmap(buf, MappedLength(bytes));
+        }
+    }
+
+    // При нехватке памяти выбрасывает std::bad_alloc, оставляя исходный блок нетронутым
+    T* reallocate(T* buf, size_t old_n, size_t new_n) {
+        const size_t old_bytes = old_n * sizeof(T);
+        const size_t new_bytes = CheckedBytes(new_n);
+
+        if (!IsMapped(old_bytes) && !IsMapped(new_bytes)) {
+            void* new_buf = std::realloc(buf, new_bytes);
+            if (new_buf == nullptr) {
+                throw std::bad_alloc();
+            }
+            return static_cast<T*>(new_buf);
+        }
+
+        if (IsMapped(old_bytes) && IsMapped(new_bytes)) {
+            const size_t old_length = MappedLength(old_bytes);
+            const size_t new_length = MappedLength(new_bytes);
+            if (old_length == new_length) {
+                return buf;
+            }
+#ifdef __linux__
+            void* new_buf = mremap(buf, old_length, new_length, MREMAP_MAYMOVE);
+            if (new_buf != MAP_FAILED) {
+#ifdef MADV_POPULATE_WRITE
+                if constexpr (Policy::kPopulate) {
+                    madvise(static_cast<char*>(new_buf) + old_length, new_length - old_length, MADV_POPULATE_WRITE);
+                }
+#endif
+                return static_cast<T*>(new_buf);
+            }
+#endif
+        }
+
+        // Буфер переходит через порог или mremap не удался: переносим байты в новый блок
+        T* new_buf = allocate(new_n);
+        std::memcpy(static_cast<void*>(new_buf), static_cast<const void*>(buf), std::min(old_bytes, new_bytes));
+        deallocate(buf, old_n);
+        return new_buf;
+    }
+
+    template <typename U>
+    bool operator==(const MmapAllocator<U, Policy>&) const noexcept {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const MmapAllocator<U, Policy>&) const noexcept {
+        return false;
+    }
+
+private:
+    static size_t CheckedBytes(size_t n) {
+        // Запас в одну огромную страницу не даёт переполниться округлению в MappedLength
+        if (n > (static_cast<size_t>(-1) - kHugePageSize) / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return n * sizeof(T);
+    }
+
+    static bool IsMapped(size_t bytes) noexcept {
+        return bytes >= Policy::kThreshold;
+    }
+
+    // Длина отображения определяется только размером буфера, поэтому deallocate и reallocate
+    // вычисляют её заново, не храня для каждого буфера способ, которым он был отображён
+    static size_t MappedLength(size_t bytes) noexcept {
+        const size_t page = Policy::kHugePages ? kHugePageSize : PageSize();
+        return (bytes + page - 1) / page * page;
+    }
+
+    static size_t PageSize() noexcept {
+        static const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        return page_size;
+    }
+
+    static void* Malloc(size_t bytes) {
+        void* buf = std::malloc(bytes == 0 ? 1 : bytes);
+        if (buf == nullptr) {
+            throw std::bad_alloc();
+        }
+        return buf;
+    }
+
+    static void* Map(size_t length) {
+        int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#ifdef MAP_POPULATE
+        if constexpr (Policy::kPopulate) {
+            flags |= MAP_POPULATE;
+        }
+#endif
+
+        if constexpr (Policy::kHugePages) {
+#ifdef MAP_HUGETLB
+            void* buf = mmap(nullptr, length, PROT_READ | PROT_WRITE, flags | MAP_HUGETLB, -1, 0);
+            if (buf != MAP_FAILED) {
+                return buf;
+            }
+#endif
+        }
+
+        void* buf = mmap(nullptr, length, PROT_READ | PROT_WRITE, flags, -1, 0);
+        if (buf == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+#ifdef MADV_HUGEPAGE
+        if constexpr (Policy::kHugePages) {
+            // Ядро без прозрачных огромных страниц просто проигнорирует совет
+            madvise(buf, length, MADV_HUGEPAGE);
+        }
+#endif
+        return buf;
+    }
+};
+
+// Вектор для больших наборов данных, буфер которого отображается через mmap
+template <typename T, typename Policy = DefaultMmapPolicy>
+using MmapVector = Vector<T, MmapAllocator<T, Policy>>;
@@ -0,0 +1,326 @@
+#pragma once
+#include "vector.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+#if defined(__linux__) && defined(SYS_mbind) && defined(SYS_move_pages)
+#define VECTOR_NUMA_SYSCALLS
+#endif
+
+// Размещение буферов больших векторов по узлам NUMA без зависимости от libnuma:
+// политика задаётся системным вызовом mbind, а узел страницы узнаётся через move_pages.
+// На системах без NUMA (или без этих вызовов) политики ничего не меняют, а NumaNodeCount() равно 1.
+//
+// Ядро выделяет физическую страницу при первой записи в неё. При политике kFirstTouch страница
+// попадает на узел записавшего потока, поэтому элементы нужно инициализировать теми потоками,
+// которые потом будут их обрабатывать: MakeFirstTouchVector делает это потоками, закреплёнными
+// за узлами, а NumaFirstTouchExecutor позволяет так же выполнять параллельные операции Vector
+// (см. ADVANCED_VECTOR_PARALLEL)
+
+enum class NumaPlacement {
+    kFirstTouch,  // страница размещается на узле потока, первым записавшего в неё
+    kInterleave,  // страницы чередуются по всем узлам
+    kBind,        // все страницы размещаются на узле NumaPolicy::node
+};
+
+struct NumaPolicy {
+    NumaPlacement placement = NumaPlacement::kInterleave;
+    int node = 0;
+
+    bool operator==(const NumaPolicy& other) const noexcept {
+        return placement == other.placement && (placement != NumaPlacement::kBind || node == other.node);
+    }
+
+    bool operator!=(const NumaPolicy& other) const noexcept {
+        return !(*this == other);
+    }
+};
+
+// Количество узлов NUMA по /sys/devices/system/node/online (например, "0-1")
+inline int NumaNodeCount() noexcept {
+    static const int count = [] {
+        int last = 0;
+        if (std::FILE* file = std::fopen("/sys/devices/system/node/online", "r")) {
+            int first = 0;
+            while (std::fscanf(file, "%d", &first) == 1) {
+                last = std::max(last, first);
+                if (std::fscanf(file, "-%d", &first) == 1) {
+                    last = std::max(last, first);
+                }
+                if (std::fgetc(file) != ',') {
+                    break;
+                }
+            }
+            std::fclose(file);
+        }
+        return last + 1;
+    }();
+    return count;
+}
+
+// Процессоры узла node по /sys/devices/system/node/nodeN/cpulist (например, "0-3,8-11")
+inline cpu_set_t NumaNodeCpus(int node) noexcept {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    char path[64];
+    std::snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+    if (std::FILE* file = std::fopen(path, "r")) {
+        int first = 0;
+        while (std::fscanf(file, "%d", &first) == 1) {
+            int last = first;
+            if (std::fscanf(file, "-%d", &last) != 1) {
+                last = first;
+            }
+            for (int cpu = first; cpu <= last && cpu < CPU_SETSIZE; ++cpu) {
+                CPU_SET(cpu, &cpus);
+            }
+            if (std::fgetc(file) != ',') {
+                break;
+            }
+        }
+        std::fclose(file);
+    }
+    return cpus;
+}
+
+// Закрепляет текущий поток за процессорами узла node. Возвращает false, если это не удалось
+inline bool PinThreadToNumaNode(int node) noexcept {
+    const cpu_set_t cpus = NumaNodeCpus(node);
+    return CPU_COUNT(&cpus) > 0 && sched_setaffinity(0, sizeof(cpus), &cpus) == 0;
+}
+
+// Узел, на котором размещена страница с адресом p, или -1, если страница ещё не выделена
+// или узел узнать нельзя
+inline int NumaNodeOf(const void* p) noexcept {
+#ifdef VECTOR_NUMA_SYSCALLS
+    void* page = const_cast<void*>(p);
+    int status = -1;
+    if (syscall(SYS_move_pages, 0, 1UL, &page, nullptr, &status, 0) == 0 && status >= 0) {
+        return status;
+    }
+#else
+    (void)p;
+#endif
+    return -1;
+}
+
+// Количество страниц диапазона [p, p + bytes), размещённых на каждом из узлов.
+// Ещё не выделенные страницы не учитываются
+inline Vector<size_t> NumaPagesPerNode(const void* p, size_t bytes) {
+    Vector<size_t> pages_per_node(static_cast<size_t>(NumaNodeCount()));
+    const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const auto first = reinterpret_cast<std::uintptr_t>(p) / page_size * page_size;
+    const auto last = reinterpret_cast<std::uintptr_t>(p) + bytes;
+    for (std::uintptr_t page = first; page < last; page += page_size) {
+        const int node = NumaNodeOf(reinterpret_cast<const void*>(page));
+        if (node >= 0 && static_cast<size_t>(node) < pages_per_node.Size()) {
+            ++pages_per_node[static_cast<size_t>(node)];
+        }
+    }
+    return pages_per_node;
+}
+
+// Исполнитель для ParallelSettings::executor: задача i выполняется в потоке, закреплённом
+// за узлом i % NumaNodeCount(). Соседние части вектора попадают на разные узлы, поэтому
+// количество частей (ParallelSettings::num_chunks) стоит делать кратным числу узлов
+inline ParallelExecutor NumaFirstTouchExecutor() {
+    return [](size_t num_tasks, const std::function<void(size_t)>& task) {
+        const int nodes = NumaNodeCount();
+        const auto run_pinned = [&task, nodes](size_t i) {
+            PinThreadToNumaNode(static_cast<int>(i % static_cast<size_t>(nodes)));
+            task(i);
+        };
+
+        std::vector<std::thread> threads;
+        size_t started = 0;
+        try {
+            threads.reserve(num_tasks);
+            for (; started < num_tasks; ++started) {
+                threads.emplace_back(run_pinned, started);
+            }
+        } catch (...) {
+            // Не удалось запустить очередной поток: оставшиеся задачи выполняются в текущем
+        }
+        for (size_t i = started; i < num_tasks; ++i) {
+            task(i);
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+    };
+}
+
+// Аллокатор, отображающий буферы через mmap и назначающий им политику NumaPolicy.
+// Политика применяется к ещё не выделенным страницам, поэтому на размещение влияет только
+// то, какой поток первым запишет в страницу (kFirstTouch), или сама политика (kInterleave, kBind).
+// Если ядро не поддерживает NUMA, политика игнорируется.
+// Vector с этим аллокатором растёт через mremap, не копируя элементы
+template <typename T>
+class NumaAllocator {
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    template <typename U>
+    struct rebind {
+        using other = NumaAllocator<U>;
+    };
+
+    NumaAllocator() noexcept = default;
+
+    explicit NumaAllocator(NumaPolicy policy) noexcept
+        : policy_(policy) {
+    }
+
+    template <typename U>
+    NumaAllocator(const NumaAllocator<U>& other) noexcept
+        : policy_(other.GetPolicy()) {
+    }
+
+    T* allocate(size_t n) {
+        const size_t length = MappedLength(CheckedBytes(n));
+        void* buf = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (buf == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        ApplyPolicy(buf, length);
+        return static_cast<T*>(buf);
+    }
+
+    void deallocate(T* buf, size_t n) noexcept {
+        munmap(buf, MappedLength(n * sizeof(T)));
+    }
+
+    // При нехватке памяти выбрасывает std::bad_alloc, оставляя исходный блок нетронутым
+    T* reallocate(T* buf, size_t old_n, size_t new_n) {
+        const size_t old_length = MappedLength(old_n * sizeof(T));
+        const size_t new_length = MappedLength(CheckedBytes(new_n));
+        if (old_length == new_length) {
+            return buf;
+        }
+#ifdef __linux__
+        void* new_buf = mremap(buf, old_length, new_length, MREMAP_MAYMOVE);
+        if (new_buf != MAP_FAILED) {
+            // Перенесённые страницы сохраняют размещение, политика нужна для новых
+            ApplyPolicy(new_buf, new_length);
+            return static_cast<T*>(new_buf);
+        }
+#endif
+        T* moved = allocate(new_n);
+        std::memcpy(static_cast<void*>(moved), static_cast<const void*>(buf), std::min(old_n, new_n) * sizeof(T));
+        deallocate(buf, old_n);
+        return moved;
+    }
+
+    NumaPolicy GetPolicy() const noexcept {
+        return policy_;
+    }
+
+    template <typename U>
+    bool operator==(const NumaAllocator<U>& other) const noexcept {
+        return policy_ == other.GetPolicy();
+    }
+
+    template <typename U>
+    bool operator!=(const NumaAllocator<U>& other) const noexcept {
+        return !(*this == other);
+    }
+
+private:
+    // Режимы mbind из <numaif.h>
+    static constexpr int kMpolBind = 2;
+    static constexpr int kMpolInterleave = 3;
+
+    static size_t CheckedBytes(size_t n) {
+        if (n > (static_cast<size_t>(-1) / 2) / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return n * sizeof(T);
+    }
+
+    static size_t MappedLength(size_t bytes) noexcept {
+        static const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        return std::max((bytes + page_size - 1) / page_size * page_size, page_size);
+    }
+
+    // Политика - лишь пожелание к размещению, поэтому ошибка mbind (например, узла нет
+    // или вызов запрещён в контейнере) оставляет размещение по умолчанию
+    void ApplyPolicy(void* buf, size_t length) const noexcept {
+#ifdef VECTOR_NUMA_SYSCALLS
+        unsigned long mask = 0;
+        int mode = 0;
+        switch (policy_.placement) {
+            case NumaPlacement::kFirstTouch:
+                return;
+            case NumaPlacement::kInterleave:
+                mode = kMpolInterleave;
+                for (int node = 0; node < NumaNodeCount() && node < kMaxNodes; ++node) {
+                    mask |= 1UL << node;
+                }
+                break;
+            case NumaPlacement::kBind:
+                if (policy_.node < 0 || policy_.node >= kMaxNodes) {
+                    return;
+                }
+                mode = kMpolBind;
+                mask = 1UL << policy_.node;
+                break;
+        }
+        syscall(SYS_mbind, buf, length, mode, &mask, static_cast<unsigned long>(kMaxNodes + 1), 0U);
+#else
+        (void)buf;
+        (void)length;
+#endif
+    }
+
+    // Маска узлов передаётся одним словом
+    static constexpr int kMaxNodes = static_cast<int>(sizeof(unsigned long) * 8);
+
+    NumaPolicy policy_;
+};
+
+template <typename T>
+using NumaVector = Vector<T, NumaAllocator<T>>;
+
+// Создаёт вектор из size элементов с политикой kFirstTouch и обнуляет их частями в потоках,
+// закреплённых за узлами: часть i попадает на узел i % NumaNodeCount(). Поток, который затем
+// обрабатывает часть вектора, следует закрепить за тем же узлом (PinThreadToNumaNode).
+// Элементы не конструируются заранее в текущем потоке, поэтому T должен быть тривиальным
+template <typename T>
+NumaVector<T> MakeFirstTouchVector(size_t size, size_t num_chunks = static_cast<size_t>(NumaNodeCount())) {
+    static_assert(std::is_trivial_v<T>, "Elements must not be touched before the parallel initialization");
+    NumaVector<T> v(NumaAllocator<T>(NumaPolicy{NumaPlacement::kFirstTouch}));
+    v.ResizeAndOverwrite(size, [num_chunks](T* data, size_t n) {
+        const size_t chunks = std::max<size_t>(std::min(num_chunks, n), 1);
+        const size_t chunk_size = (n + chunks - 1) / chunks;
+        NumaFirstTouchExecutor()(chunks, [data, n, chunk_size](size_t chunk) {
+            const size_t first = chunk * chunk_size;
+            if (first < n) {
+                std::uninitialized_value_construct_n(data + first, std::min(chunk_size, n - first));
+            }
+        });
+        return n;
+    });
+    return v;
+}
@@ -0,0 +1,110 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <new>
+#include <thread>
+#include <vector>
+
+// Параллельное выполнение массовых операций Vector (конструирование, копирование, разрушение).
+// Включается макросом ADVANCED_VECTOR_PARALLEL, который нужно определить до подключения vector.h.
+// Параллельно обрабатываются только векторы не короче ParallelSettings::threshold элементов
+
+// Исполнитель вызывает task(i) для всех i из [0, num_tasks) и возвращает управление,
+// когда все задачи завершены. Задачи не выбрасывают исключений, исполнитель тоже не должен их выбрасывать
+using ParallelExecutor = std::function<void(size_t num_tasks, const std::function<void(size_t)>& task)>;
+
+struct ParallelSettings {
+    // Минимальное количество элементов, начиная с которого операция выполняется параллельно
+    size_t threshold = size_t{1} << 16;
+    // Количество частей, на которые делится операция
+    size_t num_chunks = std::max(std::thread::hardware_concurrency(), 1u);
+    // Если не задан, каждая часть выполняется в отдельном std::thread
+    ParallelExecutor executor;
+};
+
+inline ParallelSettings& GetParallelSettings() noexcept {
+    static ParallelSettings settings;
+    return settings;
+}
+
+inline bool ShouldRunInParallel(size_t n) noexcept {
+    const ParallelSettings& settings = GetParallelSettings();
+    return settings.num_chunks > 1 && n >= settings.threshold && n >= settings.num_chunks;
+}
+
+inline void RunParallelTasks(size_t num_tasks, const std::function<void(size_t)>& task) {
+    const ParallelSettings& settings = GetParallelSettings();
+    if (settings.executor) {
+        settings.executor(num_tasks, task);
+        return;
+    }
+
+    std::vector<std::thread> threads;
+    size_t started = 1;
+    try {
+        threads.reserve(num_tasks - 1);
+        for (; started < num_tasks; ++started) {
+            threads.emplace_back(task, started);
+        }
+    } catch (...) {
+        // Не удалось запустить очередной поток: оставшиеся задачи выполняются в текущем
+    }
+    for (size_t i = started; i < num_tasks; ++i) {
+        task(i);
+    }
+    task(0);
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+// Делит [0, n) на части и вызывает fn(first, count) для каждой части параллельно.
+// Если какие-то части выбросили исключение, после завершения всех частей для каждой успешной
+// части вызывается rollback(first, count), а затем выбрасывается первое из исключений
+template <typename Fn, typename Rollback>
+void ParallelForChunks(size_t n, Fn fn, Rollback rollback) {
+    const size_t num_chunks = std::min(GetParallelSettings().num_chunks, n);
+    const size_t chunk_size = (n + num_chunks - 1) / num_chunks;
+    std::vector<std::exception_ptr> errors;
+    std::function<void(size_t)> task;
+    try {
+        errors.resize(num_chunks);
+        task = [&fn, &errors, chunk_size, n](size_t chunk) {
+            const size_t first = chunk * chunk_size;
+            const size_t count = first < n ? std::min(chunk_size, n - first) : 0;
+            try {
+                fn(first, count);
+            } catch (...) {
+                errors[chunk] = std::current_exception();
+            }
+        };
+    } catch (const std::bad_alloc&) {
+        // Без памяти под служебные данные операция выполняется в текущем потоке
+        fn(0, n);
+        return;
+    }
+
+    RunParallelTasks(num_chunks, task);
+
+    const auto failed = std::find_if(errors.begin(), errors.end(), [](const std::exception_ptr& error) {
+        return error != nullptr;
+    });
+    if (failed == errors.end()) {
+        return;
+    }
+
+    for (size_t chunk = 0; chunk < num_chunks; ++chunk) {
+        const size_t first = chunk * chunk_size;
+        if (errors[chunk] == nullptr && first < n) {
+            rollback(first, std::min(chunk_size, n - first));
+        }
+    }
+    std::rethrow_exception(*failed);
+}
+
+template <typename Fn>
+void ParallelForChunks(size_t n, Fn fn) {
+    ParallelForChunks(n, fn, [](size_t, size_t) noexcept {});
+}
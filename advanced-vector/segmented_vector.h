@@ -0,0 +1,448 @@
+#pragma once
+#include "vector.h"
+
+#include <cstddef>
+#include <iterator>
+
+// Размер блока SegmentedVector по умолчанию: наибольшая степень двойки, при которой блок
+// занимает не больше kSegmentBytes байт
+inline constexpr size_t kSegmentBytes = 64 * 1024;
+
+template <typename T>
+constexpr size_t DefaultSegmentSize() noexcept {
+    size_t size = 1;
+    while (size * 2 * sizeof(T) <= kSegmentBytes) {
+        size *= 2;
+    }
+    return size;
+}
+
+// Вектор, хранящий элементы в блоках по SegmentSize элементов. Добавление элемента
+// выделяет при необходимости только новый блок и никогда не переносит существующие
+// элементы, поэтому указатели и ссылки на них остаются действительными до удаления элемента.
+// Пиковое потребление памяти при росте превышает размер данных не больше чем на один блок
+// и каталог блоков. Индексация выполняется за O(1): номер блока и смещение в нём получаются
+// сдвигом и маской. Chunk(i) даёт непрерывный участок i-го блока для внутренних циклов
+template <typename T, size_t SegmentSize = DefaultSegmentSize<T>()>
+class SegmentedVector
+{
+    static_assert(SegmentSize > 0 && (SegmentSize & (SegmentSize - 1)) == 0, "SegmentSize must be a power of two");
+
+    static constexpr size_t kMask = SegmentSize - 1;
+
+    template <bool IsConst>
+    class BasicIterator
+    {
+        using Segments = std::conditional_t<IsConst, const RawMemory<T>*, RawMemory<T>*>;
+
+    public:
+
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<IsConst, const T*, T*>;
+        using reference = std::conditional_t<IsConst, const T&, T&>;
+
+        BasicIterator() = default;
+
+        BasicIterator(Segments segments, size_t index) noexcept
+            : segments_(segments)
+            , index_(index)
+        {
+        }
+
+        // Неконстантный итератор преобразуется в константный
+        template <bool OtherIsConst, typename = std::enable_if_t<IsConst && !OtherIsConst>>
+        BasicIterator(const BasicIterator<OtherIsConst>& other) noexcept
+            : segments_(other.segments_)
+            , index_(other.index_)
+        {
+        }
+
+        reference operator*() const noexcept
+        {
+            return segments_[index_ / SegmentSize][index_ & kMask];
+        }
+
+        pointer operator->() const noexcept
+        {
+            return &**this;
+        }
+
+        reference operator[](difference_type offset) const noexcept
+        {
+            return *(*this + offset);
+        }
+
+        BasicIterator& operator++() noexcept
+        {
+            ++index_;
+            return *this;
+        }
+
+        BasicIterator operator++(int) noexcept
+        {
+            return BasicIterator(segments_, index_++);
+        }
+
+        BasicIterator& operator--() noexcept
+        {
+            --index_;
+            return *this;
+        }
+
+        BasicIterator operator--(int) noexcept
+        {
+            return BasicIterator(segments_, index_--);
+        }
+
+        BasicIterator& operator+=(difference_type offset) noexcept
+        {
+            index_ += offset;
+            return *this;
+        }
+
+        BasicIterator& operator-=(difference_type offset) noexcept
+        {
+            index_ -= offset;
+            return *this;
+        }
+
+        friend BasicIterator operator+(BasicIterator it, difference_type offset) noexcept
+        {
+            return it += offset;
+        }
+
+        friend BasicIterator operator+(difference_type offset, BasicIterator it) noexcept
+        {
+            return it += offset;
+        }
+
+        friend BasicIterator operator-(BasicIterator it, difference_type offset) noexcept
+        {
+            return it -= offset;
+        }
+
+        friend difference_type operator-(const BasicIterator& lhs, const BasicIterator& rhs) noexcept
+        {
+            return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+        }
+
+        friend bool operator==(const BasicIterator& lhs, const BasicIterator& rhs) noexcept
+        {
+            return lhs.index_ == rhs.index_;
+        }
+
+        friend bool operator!=(const BasicIterator& lhs, const BasicIterator& rhs) noexcept
+        {
+            return lhs.index_ != rhs.index_;
+        }
+
+        friend bool operator<(const BasicIterator& lhs, const BasicIterator& rhs) noexcept
+        {
+            return lhs.index_ < rhs.index_;
+        }
+
+        friend bool operator>(const BasicIterator& lhs, const BasicIterator& rhs) noexcept
+        {
+            return rhs < lhs;
+        }
+
+        friend bool operator<=(const BasicIterator& lhs, const BasicIterator& rhs) noexcept
+        {
+            return !(rhs < lhs);
+        }
+
+        friend bool operator>=(const BasicIterator& lhs, const BasicIterator& rhs) noexcept
+        {
+            return !(lhs < rhs);
+        }
+
+    private:
+
+        friend class BasicIterator<!IsConst>;
+
+        Segments segments_ = nullptr;
+        size_t index_ = 0;
+    };
+
+public:
+
+    static constexpr size_t kSegmentSize = SegmentSize;
+
+    using iterator = BasicIterator<false>;
+    using const_iterator = BasicIterator<true>;
+
+    SegmentedVector() = default;
+
+    explicit SegmentedVector(size_t size)
+        : SegmentedVector()
+    {
+        Resize(size);
+    }
+
+    // Делегирование конструктору по умолчанию гарантирует, что при исключении
+    // деструктор разрушит уже скопированные элементы
+    SegmentedVector(const SegmentedVector& other)
+        : SegmentedVector()
+    {
+        Reserve(other.size_);
+        for (size_t i = 0; i < other.ChunkCount(); ++i)
+        {
+            const Span<const T> chunk = other.Chunk(i);
+            std::uninitialized_copy_n(chunk.begin(), chunk.Size(), segments_[i].GetAddress());
+            size_ += chunk.Size();
+        }
+    }
+
+    SegmentedVector(SegmentedVector&& other) noexcept
+        : segments_(std::move(other.segments_))
+        , size_(std::exchange(other.size_, 0))
+    {
+    }
+
+    SegmentedVector& operator=(const SegmentedVector& rhs)
+    {
+        if (this != &rhs)
+        {
+            SegmentedVector tmp(rhs);
+            Swap(tmp);
+        }
+        return *this;
+    }
+
+    SegmentedVector& operator=(SegmentedVector&& rhs) noexcept
+    {
+        if (this != &rhs)
+        {
+            Clear();
+            Swap(rhs);
+        }
+        return *this;
+    }
+
+    ~SegmentedVector()
+    {
+        Clear();
+    }
+
+    void Swap(SegmentedVector& other) noexcept
+    {
+        segments_.Swap(other.segments_);
+        std::swap(size_, other.size_);
+    }
+
+    iterator begin() noexcept
+    {
+        return iterator(segments_.Data(), 0);
+    }
+
+    iterator end() noexcept
+    {
+        return iterator(segments_.Data(), size_);
+    }
+
+    const_iterator begin() const noexcept
+    {
+        return const_iterator(segments_.Data(), 0);
+    }
+
+    const_iterator end() const noexcept
+    {
+        return const_iterator(segments_.Data(), size_);
+    }
+
+    const_iterator cbegin() const noexcept
+    {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept
+    {
+        return end();
+    }
+
+    size_t Size() const noexcept
+    {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept
+    {
+        return segments_.Size() * SegmentSize;
+    }
+
+    const T& operator[](size_t index) const noexcept
+    {
+        return const_cast<SegmentedVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept
+    {
+        assert(index < size_);
+        return segments_[index / SegmentSize][index & kMask];
+    }
+
+    // Количество блоков, в которых есть элементы
+    size_t ChunkCount() const noexcept
+    {
+        return SegmentsFor(size_);
+    }
+
+    // Элементы index-го блока. Все блоки, кроме последнего, содержат ровно SegmentSize элементов
+    Span<T> Chunk(size_t index) noexcept
+    {
+        assert(index < ChunkCount());
+        return {segments_[index].GetAddress(), std::min(SegmentSize, size_ - index * SegmentSize)};
+    }
+
+    Span<const T> Chunk(size_t index) const noexcept
+    {
+        assert(index < ChunkCount());
+        return {segments_[index].GetAddress(), std::min(SegmentSize, size_ - index * SegmentSize)};
+    }
+
+    // Выделяет блоки, которых не хватает для new_capacity элементов. Элементы не переносятся
+    void Reserve(size_t new_capacity)
+    {
+        const size_t segments = SegmentsFor(new_capacity);
+        if (segments <= segments_.Size())
+        {
+            return;
+        }
+        segments_.Reserve(segments);
+        while (segments_.Size() < segments)
+        {
+            segments_.EmplaceBack(SegmentSize);
+        }
+    }
+
+    // Строгая гарантия: если конструктор элемента выбросит исключение, добавленные элементы разрушаются
+    void Resize(size_t new_size)
+    {
+        if (new_size <= size_)
+        {
+            DestroyTail(new_size);
+            return;
+        }
+
+        Reserve(new_size);
+        const size_t old_size = size_;
+        try
+        {
+            while (size_ < new_size)
+            {
+                const size_t count = std::min(SegmentSize - (size_ & kMask), new_size - size_);
+                std::uninitialized_value_construct_n(&SlotAt(size_), count);
+                size_ += count;
+            }
+        }
+        catch (...)
+        {
+            DestroyTail(old_size);
+            throw;
+        }
+    }
+
+    // Разрушает все элементы, сохраняя выделенные блоки
+    void Clear() noexcept
+    {
+        DestroyTail(0);
+    }
+
+    // Освобождает блоки, в которых нет элементов
+    void ShrinkToFit()
+    {
+        const size_t segments = SegmentsFor(size_);
+        while (segments_.Size() > segments)
+        {
+            segments_.PopBack();
+        }
+        segments_.ShrinkToFit();
+    }
+
+    // Элементы не переезжают при росте, поэтому аргументы могут ссылаться на элементы вектора
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args)
+    {
+        if (size_ == Capacity())
+        {
+            segments_.EmplaceBack(SegmentSize);
+        }
+        T* place = new (&SlotAt(size_)) T(std::forward<Args>(args)...);
+        ++size_;
+        return *place;
+    }
+
+    void PushBack(const T& value)
+    {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value)
+    {
+        EmplaceBack(std::move(value));
+    }
+
+    void PopBack() noexcept
+    {
+        assert(size_ > 0);
+        --size_;
+        std::destroy_at(&SlotAt(size_));
+    }
+
+    // Копирует элементы в один непрерывный Vector
+    Vector<T> Flatten() const&
+    {
+        Vector<T> result;
+        result.Reserve(size_);
+        for (size_t i = 0; i < ChunkCount(); ++i)
+        {
+            const Span<const T> chunk = Chunk(i);
+            result.Append(chunk.begin(), chunk.end());
+        }
+        return result;
+    }
+
+    // Перемещает элементы в один непрерывный Vector и освобождает блоки
+    Vector<T> Flatten() &&
+    {
+        Vector<T> result;
+        result.Reserve(size_);
+        for (size_t i = 0; i < ChunkCount(); ++i)
+        {
+            const Span<T> chunk = Chunk(i);
+            result.Append(std::make_move_iterator(chunk.begin()), std::make_move_iterator(chunk.end()));
+        }
+        Clear();
+        segments_ = Vector<RawMemory<T>>();
+        return result;
+    }
+
+private:
+
+    static size_t SegmentsFor(size_t size) noexcept
+    {
+        return size / SegmentSize + ((size & kMask) != 0);
+    }
+
+    // Место под элемент с индексом index внутри выделенных блоков
+    T& SlotAt(size_t index) noexcept
+    {
+        return *(segments_[index / SegmentSize].GetAddress() + (index & kMask));
+    }
+
+    // Разрушает элементы начиная с new_size, по блоку за раз
+    void DestroyTail(size_t new_size) noexcept
+    {
+        while (size_ > new_size)
+        {
+            const size_t first = std::max(new_size, (size_ - 1) & ~kMask);
+            std::destroy_n(&SlotAt(first), size_ - first);
+            size_ = first;
+        }
+    }
+
+    Vector<RawMemory<T>> segments_;
+    size_t size_ = 0;
+};
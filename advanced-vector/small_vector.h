@@ -0,0 +1,288 @@
+#pragma once
+#include "vector.h"
+
+#include <cstddef>
+#include <memory>
+
+// Вектор, хранящий до N элементов во встроенном буфере без обращения к куче.
+// Когда элементы перестают помещаться во встроенный буфер, они переносятся в RawMemory,
+// после чего SmallVector ведёт себя так же, как Vector, и даёт те же гарантии безопасности исключений.
+// Ёмкость внешнего буфера при вставке выбирает политика роста Growth, как у Vector.
+// Перенос элементов и вставка со сдвигом хвоста выполняются теми же операциями ElementOps, что и в Vector
+template <typename T, size_t N, typename Growth = DoublingGrowth>
+class SmallVector : private ElementOps<T, std::allocator<T>>
+{
+    static_assert(N > 0, "Use Vector<T> when no inline storage is needed");
+
+    using Ops = ElementOps<T, std::allocator<T>>;
+
+public:
+
+    SmallVector() noexcept = default;
+
+    explicit SmallVector(size_t size)
+    {
+        Reserve(size);
+        Ops::UninitializedValueConstructN(GetAllocator(), Data(), size);
+        size_ = size;
+    }
+
+    SmallVector(const SmallVector& other)
+    {
+        Reserve(other.size_);
+        Ops::UninitializedCopyN(GetAllocator(), other.Data(), other.size_, Data());
+        size_ = other.size_;
+    }
+
+    SmallVector(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+    {
+        TakeFrom(other);
+    }
+
+    SmallVector& operator=(const SmallVector& rhs)
+    {
+        if (this != &rhs)
+        {
+            SmallVector tmp(rhs);
+            *this = std::move(tmp);
+        }
+        return *this;
+    }
+
+    SmallVector& operator=(SmallVector&& rhs) noexcept(std::is_nothrow_move_constructible_v<T>)
+    {
+        if (this != &rhs)
+        {
+            Clear();
+            TakeFrom(rhs);
+        }
+        return *this;
+    }
+
+    ~SmallVector()
+    {
+        Ops::DestroyN(GetAllocator(), Data(), size_);
+    }
+
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    iterator begin() noexcept
+    {
+        return Data();
+    }
+
+    iterator end() noexcept
+    {
+        return Data() + size_;
+    }
+
+    const_iterator begin() const noexcept
+    {
+        return Data();
+    }
+
+    const_iterator end() const noexcept
+    {
+        return Data() + size_;
+    }
+
+    const_iterator cbegin() const noexcept
+    {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept
+    {
+        return end();
+    }
+
+    size_t Size() const noexcept
+    {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept
+    {
+        return IsInline() ? N : heap_.Capacity();
+    }
+
+    // Возвращает true, пока элементы хранятся во встроенном буфере
+    bool IsInline() const noexcept
+    {
+        return heap_.Capacity() == 0;
+    }
+
+    const T& operator[](size_t index) const noexcept
+    {
+        return const_cast<SmallVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept
+    {
+        assert(index < size_);
+        return Data()[index];
+    }
+
+    void Reserve(size_t new_capacity)
+    {
+        if (new_capacity > Capacity())
+        {
+            RawMemory<T> new_data(new_capacity);
+            MoveOrCopy(new_data);
+        }
+    }
+
+    void Resize(size_t new_size)
+    {
+        if (new_size < size_)
+        {
+            Ops::DestroyN(GetAllocator(), Data() + new_size, size_ - new_size);
+        }
+        else
+        {
+            Reserve(new_size);
+            Ops::UninitializedValueConstructN(GetAllocator(), Data() + size_, new_size - size_);
+        }
+        size_ = new_size;
+    }
+
+    void Clear() noexcept
+    {
+        Ops::DestroyN(GetAllocator(), Data(), size_);
+        size_ = 0;
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args)
+    {
+        return *Emplace(cend(), std::forward<Args>(args)...);
+    }
+
+    void PushBack(const T& value)
+    {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value)
+    {
+        EmplaceBack(std::move(value));
+    }
+
+    void PopBack() noexcept
+    {
+        assert(size_ > 0);
+        Ops::DestroyAt(GetAllocator(), Data() + size_ - 1);
+        --size_;
+    }
+
+    template <typename... Args>
+    iterator Emplace(const_iterator pos, Args&&... args)
+    {
+        assert(pos >= cbegin() && pos <= cend());
+        const size_t offset = pos - cbegin();
+
+        if (size_ == Capacity())
+        {
+            RawMemory<T> new_data(GrowCapacity(size_ + 1));
+            Ops::ConstructAt(GetAllocator(), new_data + offset, std::forward<Args>(args)...);
+
+            try
+            {
+                Ops::MoveOrCopyAllWithGap(GetAllocator(), Data(), size_, new_data.GetAddress(), offset, 1);
+            }
+            catch (...)
+            {
+                Ops::DestroyAt(GetAllocator(), new_data + offset);
+                throw;
+            }
+            heap_.Swap(new_data);
+        }
+        else
+        {
+            Ops::EmplaceNoAllocation(GetAllocator(), Data(), size_, offset, std::forward<Args>(args)...);
+        }
+
+        ++size_;
+
+        return Data() + offset;
+    }
+
+    iterator Insert(const_iterator pos, const T& value)
+    {
+        return Emplace(pos, value);
+    }
+
+    iterator Insert(const_iterator pos, T&& value)
+    {
+        return Emplace(pos, std::move(value));
+    }
+
+    iterator Erase(const_iterator pos) noexcept(std::is_nothrow_move_assignable_v<T>)
+    {
+        assert(pos >= cbegin() && pos < cend());
+        iterator it = begin() + (pos - cbegin());
+
+        std::move(it + 1, end(), it);
+        PopBack();
+
+        return it;
+    }
+
+    void Swap(SmallVector& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+    {
+        SmallVector tmp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+private:
+
+    T* Data() noexcept
+    {
+        return IsInline() ? reinterpret_cast<T*>(inline_) : heap_.GetAddress();
+    }
+
+    const T* Data() const noexcept
+    {
+        return const_cast<SmallVector&>(*this).Data();
+    }
+
+    std::allocator<T>& GetAllocator() noexcept
+    {
+        return heap_.GetAllocator();
+    }
+
+    size_t GrowCapacity(size_t required) const noexcept
+    {
+        const size_t new_capacity = Growth::NextCapacity(Capacity(), required, sizeof(T));
+        assert(new_capacity >= required);
+        return new_capacity;
+    }
+
+    // Переносит элементы в new_data и делает её внешним буфером
+    void MoveOrCopy(RawMemory<T>& new_data)
+    {
+        Ops::MoveOrCopyAll(GetAllocator(), Data(), size_, new_data.GetAddress());
+        heap_.Swap(new_data);
+    }
+
+    // Забирает содержимое other, оставляя его пустым. *this должен быть пуст
+    void TakeFrom(SmallVector& other)
+    {
+        assert(size_ == 0);
+        if (other.IsInline())
+        {
+            Ops::MoveOrCopyAll(GetAllocator(), other.Data(), other.size_, Data());
+        }
+        else
+        {
+            heap_ = std::move(other.heap_);
+        }
+        size_ = std::exchange(other.size_, 0);
+    }
+
+    RawMemory<T> heap_;
+    size_t size_ = 0;
+    alignas(T) std::byte inline_[N * sizeof(T)];
+};
@@ -0,0 +1,380 @@
+#pragma once
+#include "vector.h"
+
+#include <cstddef>
+#include <tuple>
+#include <utility>
+
+// Непрерывный участок одного столбца SoAVector
+template <typename T>
+using ColumnSpan = Span<T>;
+
+// Вектор строк из полей Fields..., каждое из которых хранится в собственном столбце RawMemory.
+// Цикл, читающий только часть полей, загружает в кэш только их столбцы.
+// Column<I>() даёт непрерывный участок I-го столбца, operator[] - строку в виде кортежа ссылок
+// на её поля. Все столбцы растут одновременно, а рост даёт строгую гарантию безопасности
+// исключений: если копирование какого-либо столбца выбросит исключение, вектор не изменится.
+// Новую ёмкость выбирает политика роста Growth, как у Vector, а размером элемента для неё
+// считается размер строки. Поля перечисляются последними, поэтому политика задаётся первым
+// параметром BasicSoAVector, а SoAVector использует удвоение
+template <typename Growth, typename... Fields>
+class BasicSoAVector
+{
+    static_assert(sizeof...(Fields) > 0, "SoAVector needs at least one field");
+
+    template <size_t I>
+    using FieldType = std::tuple_element_t<I, std::tuple<Fields...>>;
+
+    using Columns = std::tuple<RawMemory<Fields>...>;
+
+    static constexpr size_t kRowSize = (sizeof(Fields) + ...);
+
+public:
+
+    using Row = std::tuple<Fields&...>;
+    using ConstRow = std::tuple<const Fields&...>;
+
+    BasicSoAVector() = default;
+
+    explicit BasicSoAVector(size_t size)
+    {
+        Resize(size);
+    }
+
+    BasicSoAVector(const BasicSoAVector& other)
+    {
+        Columns columns = AllocateColumns(other.size_);
+        ForEachColumnWithRollback([&](auto column) {
+            constexpr size_t I = decltype(column)::value;
+            std::uninitialized_copy_n(other.GetColumn<I>().GetAddress(), other.size_, std::get<I>(columns).GetAddress());
+        }, [&](auto column) {
+            constexpr size_t I = decltype(column)::value;
+            std::destroy_n(std::get<I>(columns).GetAddress(), other.size_);
+        });
+        columns_.swap(columns);
+        size_ = other.size_;
+    }
+
+    BasicSoAVector(BasicSoAVector&& other) noexcept
+        : columns_(std::move(other.columns_))
+        , size_(std::exchange(other.size_, 0))
+    {
+    }
+
+    BasicSoAVector& operator=(const BasicSoAVector& rhs)
+    {
+        if (this != &rhs)
+        {
+            BasicSoAVector tmp(rhs);
+            Swap(tmp);
+        }
+        return *this;
+    }
+
+    BasicSoAVector& operator=(BasicSoAVector&& rhs) noexcept
+    {
+        if (this != &rhs)
+        {
+            Clear();
+            Swap(rhs);
+        }
+        return *this;
+    }
+
+    ~BasicSoAVector()
+    {
+        DestroyRows(0, size_);
+    }
+
+    void Swap(BasicSoAVector& other) noexcept
+    {
+        ForEachColumn([&](auto column) {
+            constexpr size_t I = decltype(column)::value;
+            GetColumn<I>().Swap(other.GetColumn<I>());
+        });
+        std::swap(size_, other.size_);
+    }
+
+    size_t Size() const noexcept
+    {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept
+    {
+        return std::get<0>(columns_).Capacity();
+    }
+
+    template <size_t I>
+    ColumnSpan<FieldType<I>> Column() noexcept
+    {
+        return {GetColumn<I>().GetAddress(), size_};
+    }
+
+    template <size_t I>
+    ColumnSpan<const FieldType<I>> Column() const noexcept
+    {
+        return {GetColumn<I>().GetAddress(), size_};
+    }
+
+    Row operator[](size_t index) noexcept
+    {
+        assert(index < size_);
+        return RowAt(index, std::index_sequence_for<Fields...>{});
+    }
+
+    ConstRow operator[](size_t index) const noexcept
+    {
+        assert(index < size_);
+        return const_cast<BasicSoAVector&>(*this).RowAt(index, std::index_sequence_for<Fields...>{});
+    }
+
+    void Reserve(size_t new_capacity)
+    {
+        if (new_capacity <= Capacity())
+        {
+            return;
+        }
+
+        Columns new_columns = AllocateColumns(new_capacity);
+        MoveOrCopy(new_columns);
+    }
+
+    void Resize(size_t new_size)
+    {
+        if (new_size < size_)
+        {
+            DestroyRows(new_size, size_ - new_size);
+        }
+        else
+        {
+            Reserve(new_size);
+            const size_t count = new_size - size_;
+            ForEachColumnWithRollback([&](auto column) {
+                std::uninitialized_value_construct_n(GetColumn<decltype(column)::value>() + size_, count);
+            }, [&](auto column) {
+                std::destroy_n(GetColumn<decltype(column)::value>() + size_, count);
+            });
+        }
+        size_ = new_size;
+    }
+
+    void Clear() noexcept
+    {
+        DestroyRows(0, size_);
+        size_ = 0;
+    }
+
+    // Добавляет строку, конструируя I-е поле из I-го аргумента
+    template <typename... Args>
+    Row EmplaceBack(Args&&... args)
+    {
+        static_assert(sizeof...(Args) == sizeof...(Fields), "EmplaceBack expects one argument per field");
+
+        if (size_ == Capacity())
+        {
+            // Аргументы могут ссылаться на поля вектора, поэтому новая строка конструируется
+            // в новых столбцах до того, как в них будут перенесены старые строки
+            Columns new_columns = AllocateColumns(Growth::NextCapacity(Capacity(), size_ + 1, kRowSize));
+            ConstructRow(new_columns, size_, std::index_sequence_for<Fields...>{}, std::forward<Args>(args)...);
+            try
+            {
+                MoveOrCopy(new_columns);
+            }
+            catch (...)
+            {
+                DestroyRow(new_columns, size_);
+                throw;
+            }
+        }
+        else
+        {
+            ConstructRow(columns_, size_, std::index_sequence_for<Fields...>{}, std::forward<Args>(args)...);
+        }
+
+        ++size_;
+        return (*this)[size_ - 1];
+    }
+
+    void PopBack() noexcept
+    {
+        assert(size_ > 0);
+        DestroyRows(size_ - 1, 1);
+        --size_;
+    }
+
+    // Удаляет строки [first, last), сдвигая хвост каждого столбца
+    void Erase(size_t first, size_t last) noexcept((std::is_nothrow_move_assignable_v<Fields> && ...))
+    {
+        assert(first <= last && last <= size_);
+        const size_t count = last - first;
+        if (count == 0)
+        {
+            return;
+        }
+        ForEachColumn([&](auto column) {
+            auto* data = GetColumn<decltype(column)::value>().GetAddress();
+            std::move(data + last, data + size_, data + first);
+        });
+        DestroyRows(size_ - count, count);
+        size_ -= count;
+    }
+
+    void Erase(size_t index) noexcept((std::is_nothrow_move_assignable_v<Fields> && ...))
+    {
+        assert(index < size_);
+        Erase(index, index + 1);
+    }
+
+private:
+
+    // Поля типа T копируются при росте, если перемещение может выбросить исключение
+    template <typename T>
+    static constexpr bool kMustCopy = !IsTriviallyRelocatableV<T> && !std::is_nothrow_move_constructible_v<T>
+        && std::is_copy_constructible_v<T>;
+
+    template <size_t I>
+    RawMemory<FieldType<I>>& GetColumn() noexcept
+    {
+        return std::get<I>(columns_);
+    }
+
+    template <size_t I>
+    const RawMemory<FieldType<I>>& GetColumn() const noexcept
+    {
+        return std::get<I>(columns_);
+    }
+
+    template <size_t... Is>
+    Row RowAt(size_t index, std::index_sequence<Is...>) noexcept
+    {
+        return Row(GetColumn<Is>()[index]...);
+    }
+
+    static Columns AllocateColumns(size_t capacity)
+    {
+        return Columns(RawMemory<Fields>(capacity)...);
+    }
+
+    // Вызывает fn(std::integral_constant<size_t, I>) для каждого столбца I
+    template <typename Fn>
+    static void ForEachColumn(Fn&& fn)
+    {
+        ForEachColumnImpl(fn, std::index_sequence_for<Fields...>{});
+    }
+
+    template <typename Fn, size_t... Is>
+    static void ForEachColumnImpl(Fn& fn, std::index_sequence<Is...>)
+    {
+        (fn(std::integral_constant<size_t, Is>{}), ...);
+    }
+
+    // Вызывает process для каждого столбца по порядку. Если process выбросит исключение,
+    // для уже обработанных столбцов вызывается rollback
+    template <typename Process, typename Rollback>
+    static void ForEachColumnWithRollback(Process process, Rollback rollback)
+    {
+        size_t processed = 0;
+        try
+        {
+            ForEachColumn([&](auto column) {
+                process(column);
+                ++processed;
+            });
+        }
+        catch (...)
+        {
+            ForEachColumn([&](auto column) {
+                if (decltype(column)::value < processed)
+                {
+                    rollback(column);
+                }
+            });
+            throw;
+        }
+    }
+
+    template <size_t... Is, typename... Args>
+    static void ConstructRow(Columns& columns, size_t index, std::index_sequence<Is...>, Args&&... args)
+    {
+        size_t constructed = 0;
+        try
+        {
+            ((new (std::get<Is>(columns) + index) FieldType<Is>(std::forward<Args>(args)), ++constructed), ...);
+        }
+        catch (...)
+        {
+            ForEachColumn([&](auto column) {
+                if (decltype(column)::value < constructed)
+                {
+                    std::destroy_at(std::get<decltype(column)::value>(columns) + index);
+                }
+            });
+            throw;
+        }
+    }
+
+    static void DestroyRow(Columns& columns, size_t index) noexcept
+    {
+        ForEachColumn([&](auto column) {
+            std::destroy_at(std::get<decltype(column)::value>(columns) + index);
+        });
+    }
+
+    void DestroyRows(size_t first, size_t count) noexcept
+    {
+        ForEachColumn([&](auto column) {
+            std::destroy_n(GetColumn<decltype(column)::value>() + first, count);
+        });
+    }
+
+    // Переносит строки в new_columns. Сначала копируются столбцы, которые нельзя переместить
+    // без риска исключения: пока они не скопированы, исходные строки остаются нетронутыми.
+    // Остальные столбцы затем перемещаются или переносятся побайтово без исключений
+    void MoveOrCopy(Columns& new_columns)
+    {
+        ForEachColumnWithRollback([&](auto column) {
+            constexpr size_t I = decltype(column)::value;
+            if constexpr (kMustCopy<FieldType<I>>)
+            {
+                std::uninitialized_copy_n(GetColumn<I>().GetAddress(), size_, std::get<I>(new_columns).GetAddress());
+            }
+        }, [&](auto column) {
+            constexpr size_t I = decltype(column)::value;
+            if constexpr (kMustCopy<FieldType<I>>)
+            {
+                std::destroy_n(std::get<I>(new_columns).GetAddress(), size_);
+            }
+        });
+
+        ForEachColumn([&](auto column) {
+            constexpr size_t I = decltype(column)::value;
+            using Field = FieldType<I>;
+            Field* from = GetColumn<I>().GetAddress();
+            Field* to = std::get<I>(new_columns).GetAddress();
+            if constexpr (IsTriviallyRelocatableV<Field>)
+            {
+                if (size_ != 0)
+                {
+                    std::memcpy(static_cast<void*>(to), static_cast<const void*>(from), size_ * sizeof(Field));
+                }
+            }
+            else
+            {
+                if constexpr (!kMustCopy<Field>)
+                {
+                    std::uninitialized_move_n(from, size_, to);
+                }
+                std::destroy_n(from, size_);
+            }
+        });
+
+        columns_.swap(new_columns);
+    }
+
+    Columns columns_;
+    size_t size_ = 0;
+};
+
+template <typename... Fields>
+using SoAVector = BasicSoAVector<DoublingGrowth, Fields...>;
@@ -0,0 +1,433 @@
+#pragma once
+#include "vector.h"
+
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+
+// Хранилище StaticVector: встроенный буфер на N элементов и их количество
+template <typename T, size_t N>
+class StaticVectorBuffer
+{
+protected:
+
+    T* Data() noexcept
+    {
+        return reinterpret_cast<T*>(data_);
+    }
+
+    const T* Data() const noexcept
+    {
+        return reinterpret_cast<const T*>(data_);
+    }
+
+    size_t size_ = 0;
+    alignas(T) std::byte data_[N * sizeof(T)];
+};
+
+// Для тривиально копируемых T подходят копирование и разрушение, созданные компилятором:
+// тогда и сам StaticVector тривиально копируем. Для остальных T элементы копируются,
+// перемещаются и разрушаются поштучно
+template <typename T, size_t N, bool = std::is_trivially_copyable_v<T>>
+class StaticVectorStorage : public StaticVectorBuffer<T, N>
+{
+};
+
+template <typename T, size_t N>
+class StaticVectorStorage<T, N, false> : public StaticVectorBuffer<T, N>
+{
+    using Buffer = StaticVectorBuffer<T, N>;
+
+protected:
+
+    StaticVectorStorage() noexcept = default;
+
+    StaticVectorStorage(const StaticVectorStorage& other)
+    {
+        std::uninitialized_copy_n(other.Data(), other.size_, Buffer::Data());
+        Buffer::size_ = other.size_;
+    }
+
+    StaticVectorStorage(StaticVectorStorage&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+    {
+        std::uninitialized_move_n(other.Data(), other.size_, Buffer::Data());
+        Buffer::size_ = other.size_;
+    }
+
+    StaticVectorStorage& operator=(const StaticVectorStorage& rhs)
+    {
+        if (this != &rhs)
+        {
+            AssignFrom(rhs.Data(), rhs.size_, [](const T* from, size_t n, T* to) {
+                std::copy_n(from, n, to);
+            }, [](const T* from, size_t n, T* to) {
+                std::uninitialized_copy_n(from, n, to);
+            });
+        }
+        return *this;
+    }
+
+    StaticVectorStorage& operator=(StaticVectorStorage&& rhs) noexcept(std::is_nothrow_move_assignable_v<T>
+                                                                       && std::is_nothrow_move_constructible_v<T>)
+    {
+        if (this != &rhs)
+        {
+            AssignFrom(rhs.Data(), rhs.size_, [](T* from, size_t n, T* to) {
+                std::move(from, from + n, to);
+            }, [](T* from, size_t n, T* to) {
+                std::uninitialized_move_n(from, n, to);
+            });
+        }
+        return *this;
+    }
+
+    ~StaticVectorStorage()
+    {
+        std::destroy_n(Buffer::Data(), Buffer::size_);
+    }
+
+private:
+
+    // Присваивает общим элементам значения from при помощи assign, лишние элементы
+    // разрушает, а недостающие конструирует при помощи construct
+    template <typename From, typename Assign, typename Construct>
+    void AssignFrom(From* from, size_t size, Assign assign, Construct construct)
+    {
+        T* data = Buffer::Data();
+        if (size <= Buffer::size_)
+        {
+            assign(from, size, data);
+            std::destroy_n(data + size, Buffer::size_ - size);
+        }
+        else
+        {
+            assign(from, Buffer::size_, data);
+            construct(from + Buffer::size_, size - Buffer::size_, data + Buffer::size_);
+        }
+        Buffer::size_ = size;
+    }
+};
+
+// Вектор ёмкостью не более N элементов, хранящий их во встроенном буфере и никогда не
+// обращающийся к куче. Добавление элемента в заполненный вектор выбрасывает std::length_error,
+// а TryEmplaceBack в этом случае возвращает false. Если T тривиально копируем,
+// StaticVector тоже тривиально копируем, и его можно копировать через memcpy
+template <typename T, size_t N>
+class StaticVector : private StaticVectorStorage<T, N>, private ElementOps<T, std::allocator<T>>
+{
+    static_assert(N > 0, "StaticVector needs room for at least one element");
+
+    using Storage = StaticVectorStorage<T, N>;
+    using Ops = ElementOps<T, std::allocator<T>>;
+    using Storage::Data;
+    using Storage::size_;
+
+public:
+
+    StaticVector() noexcept = default;
+
+    explicit StaticVector(size_t size)
+    {
+        CheckCapacity(size);
+        std::uninitialized_value_construct_n(Data(), size);
+        size_ = size;
+    }
+
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    iterator begin() noexcept
+    {
+        return Data();
+    }
+
+    iterator end() noexcept
+    {
+        return Data() + size_;
+    }
+
+    const_iterator begin() const noexcept
+    {
+        return Data();
+    }
+
+    const_iterator end() const noexcept
+    {
+        return Data() + size_;
+    }
+
+    const_iterator cbegin() const noexcept
+    {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept
+    {
+        return end();
+    }
+
+    size_t Size() const noexcept
+    {
+        return size_;
+    }
+
+    static constexpr size_t Capacity() noexcept
+    {
+        return N;
+    }
+
+    const T& operator[](size_t index) const noexcept
+    {
+        return const_cast<StaticVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept
+    {
+        assert(index < size_);
+        return Data()[index];
+    }
+
+    void Resize(size_t new_size)
+    {
+        if (new_size < size_)
+        {
+            std::destroy_n(Data() + new_size, size_ - new_size);
+        }
+        else
+        {
+            CheckCapacity(new_size);
+            std::uninitialized_value_construct_n(Data() + size_, new_size - size_);
+        }
+        size_ = new_size;
+    }
+
+    void Clear() noexcept
+    {
+        std::destroy_n(Data(), size_);
+        size_ = 0;
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args)
+    {
+        CheckCapacity(size_ + 1);
+        T* place = new (Data() + size_) T(std::forward<Args>(args)...);
+        ++size_;
+        return *place;
+    }
+
+    // Добавляет элемент, если в буфере есть место, и возвращает false, если его нет
+    template <typename... Args>
+    bool TryEmplaceBack(Args&&... args)
+    {
+        if (size_ == N)
+        {
+            return false;
+        }
+        new (Data() + size_) T(std::forward<Args>(args)...);
+        ++size_;
+        return true;
+    }
+
+    void PushBack(const T& value)
+    {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value)
+    {
+        EmplaceBack(std::move(value));
+    }
+
+    void PopBack() noexcept
+    {
+        assert(size_ > 0);
+        std::destroy_at(Data() + size_ - 1);
+        --size_;
+    }
+
+    template <typename... Args>
+    iterator Emplace(const_iterator pos, Args&&... args)
+    {
+        assert(pos >= cbegin() && pos <= cend());
+        const size_t offset = pos - cbegin();
+        CheckRoom(1);
+
+        std::allocator<T> alloc;
+        Ops::EmplaceNoAllocation(alloc, Data(), size_, offset, std::forward<Args>(args)...);
+        ++size_;
+
+        return Data() + offset;
+    }
+
+    iterator Insert(const_iterator pos, const T& value)
+    {
+        return Emplace(pos, value);
+    }
+
+    iterator Insert(const_iterator pos, T&& value)
+    {
+        return Emplace(pos, std::move(value));
+    }
+
+    // Вставляет count копий value перед pos
+    iterator Insert(const_iterator pos, size_t count, const T& value)
+    {
+        const size_t offset = pos - cbegin();
+        const auto insert_copies = [this, offset, count](const T& item) {
+            return InsertN(offset, count,
+                [&item](T* to, size_t, size_t n) { std::uninitialized_fill_n(to, n, item); },
+                [&item](T* to, size_t, size_t n) { std::fill_n(to, n, item); });
+        };
+
+        if (Ops::IsInsideElements(value, Data(), size_))
+        {
+            // value ссылается на элемент вектора, который может быть сдвинут при вставке
+            const T copy(value);
+            return insert_copies(copy);
+        }
+
+        return insert_copies(value);
+    }
+
+    // Вставляет перед pos элементы диапазона [first, last), который не должен ссылаться на элементы вектора.
+    // Для однонаправленных итераторов место проверяется и хвост сдвигается один раз
+    template <typename InputIt, typename = std::enable_if_t<std::is_convertible_v<
+        typename std::iterator_traits<InputIt>::iterator_category, std::input_iterator_tag>>>
+    iterator Insert(const_iterator pos, InputIt first, InputIt last)
+    {
+        const size_t offset = pos - cbegin();
+
+        using Category = typename std::iterator_traits<InputIt>::iterator_category;
+        if constexpr (std::is_convertible_v<Category, std::forward_iterator_tag>)
+        {
+            const size_t count = static_cast<size_t>(std::distance(first, last));
+
+            return InsertN(offset, count,
+                [first](T* to, size_t from, size_t n) {
+                    std::allocator<T> alloc;
+                    Ops::UninitializedCopyN(alloc, std::next(first, from), n, to);
+                },
+                [first](T* to, size_t from, size_t n) { std::copy_n(std::next(first, from), n, to); });
+        }
+        else
+        {
+            // Количество элементов заранее неизвестно: дописываем их в конец и переставляем на место
+            const size_t old_size = size_;
+            for (; first != last; ++first)
+            {
+                EmplaceBack(*first);
+            }
+            std::rotate(begin() + offset, begin() + old_size, end());
+            return begin() + offset;
+        }
+    }
+
+    iterator Insert(const_iterator pos, std::initializer_list<T> values)
+    {
+        return Insert(pos, values.begin(), values.end());
+    }
+
+    iterator Erase(const_iterator pos) noexcept(std::is_nothrow_move_assignable_v<T>)
+    {
+        assert(pos >= cbegin() && pos < cend());
+        return Erase(pos, pos + 1);
+    }
+
+    // Удаляет элементы [first, last), сдвигая хвост вектора один раз
+    iterator Erase(const_iterator first, const_iterator last) noexcept(std::is_nothrow_move_assignable_v<T>)
+    {
+        assert(cbegin() <= first && first <= last && last <= cend());
+        iterator it = begin() + (first - cbegin());
+        const size_t count = last - first;
+        if (count == 0)
+        {
+            return it;
+        }
+
+        std::move(it + count, end(), it);
+        std::destroy_n(end() - count, count);
+        size_ -= count;
+
+        return it;
+    }
+
+private:
+
+    static void CheckCapacity(size_t size)
+    {
+        if (size > N)
+        {
+            throw std::length_error("StaticVector capacity exceeded");
+        }
+    }
+
+    // Проверяет, что в буфере есть место ещё для count элементов
+    void CheckRoom(size_t count) const
+    {
+        if (count > N - size_)
+        {
+            throw std::length_error("StaticVector capacity exceeded");
+        }
+    }
+
+    // Вставляет count элементов перед позицией offset, сдвигая хвост вектора один раз, так же,
+    // как Vector::InsertN без реаллокации. construct(to, first, n) конструирует в неинициализированной
+    // памяти to вставляемые элементы с индексами [first, first + n), assign(to, first, n)
+    // присваивает их уже существующим элементам
+    template <typename Construct, typename Assign>
+    iterator InsertN(size_t offset, size_t count, Construct construct, Assign assign)
+    {
+        CheckRoom(count);
+        if (count == 0)
+        {
+            return begin() + offset;
+        }
+
+        std::allocator<T> alloc;
+        const size_t tail = size_ - offset;
+        T* gap = Data() + offset;
+        T* old_end = Data() + size_;
+
+        if (Ops::CanRelocate())
+        {
+            // Хвост переносится побайтово, а при исключении возвращается на место
+            Ops::RelocateOverlapping(gap, tail, gap + count);
+            try
+            {
+                construct(gap, 0, count);
+            }
+            catch (...)
+            {
+                Ops::RelocateOverlapping(gap + count, tail, gap);
+                throw;
+            }
+            size_ += count;
+        }
+        else if (tail > count)
+        {
+            Ops::UninitializedMoveOrCopyN(alloc, old_end - count, count, old_end);
+            size_ += count;
+            std::move_backward(gap, old_end - count, old_end);
+            assign(gap, 0, count);
+        }
+        else
+        {
+            construct(old_end, tail, count - tail);
+            try
+            {
+                Ops::UninitializedMoveOrCopyN(alloc, gap, tail, old_end + (count - tail));
+            }
+            catch (...)
+            {
+                Ops::DestroyN(alloc, old_end, count - tail);
+                throw;
+            }
+            size_ += count;
+            assign(gap, 0, tail);
+        }
+
+        return begin() + offset;
+    }
+};
@@ -1,301 +1,1764 @@
 #pragma once
 #include <algorithm>
 #include <cassert>
+#include <cstddef>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
 #include <new>
+#include <stdexcept>
 #include <utility>
 #include <memory>
 #include <iostream>
+#include <type_traits>
+
+#include "vector_stats.h"
+
+// Под C++20 RawMemory и Vector можно использовать в константных выражениях, например, чтобы
+// построить таблицу во время компиляции. При константном вычислении элементы конструируются
+// по одному через аллокатор, а побайтовый перенос и параллельные алгоритмы не используются
+#if defined(__cpp_lib_constexpr_dynamic_alloc) && defined(__cpp_lib_is_constant_evaluated)
+#define VECTOR_CONSTEXPR constexpr
+#else
+#define VECTOR_CONSTEXPR
+#endif
+
+constexpr bool IsConstantEvaluated() noexcept {
+#ifdef __cpp_lib_is_constant_evaluated
+    return std::is_constant_evaluated();
+#else
+    return false;
+#endif
+}
+
+#ifdef ADVANCED_VECTOR_PARALLEL
+#include "parallel.h"
+#endif
+
+// Усиленный режим (ADVANCED_VECTOR_HARDENED) проверяет индексы и итераторы Vector во время
+// выполнения, в том числе при NDEBUG. Итераторы становятся объектами CheckedIterator, которые
+// помнят поколение буфера и обнаруживают обращение после реаллокации. Нарушение проверки
+// печатает сообщение и аварийно завершает программу. Без макроса итераторы остаются
+// указателями, а проверки не генерируют кода
+#ifdef ADVANCED_VECTOR_HARDENED
+[[noreturn]] inline void HardenedVectorFailure(const char* message) noexcept {
+    std::fprintf(stderr, "Vector: %s\n", message);
+    std::abort();
+}
+
+#define VECTOR_HARDENED_CHECK(condition, message) ((condition) ? void(0) : HardenedVectorFailure(message))
+#else
+#define VECTOR_HARDENED_CHECK(condition, message) ((void)0)
+#endif
+
+// Признак того, что объект типа T можно переместить в другую область памяти побайтовым
+// копированием, не вызывая конструктор перемещения и деструктор исходного объекта.
+// Для своих типов (например, хранящих только указатель на кучу) шаблон можно специализировать
+template <typename T>
+struct IsTriviallyRelocatable : std::bool_constant<std::is_trivially_copyable_v<T>> {};
+
+template <typename T>
+struct IsTriviallyRelocatable<std::unique_ptr<T>> : std::true_type {};
+
+template <typename T>
+inline constexpr bool IsTriviallyRelocatableV = IsTriviallyRelocatable<T>::value;
+
+// Типичный размер строки кэша. Буферы, выровненные по этой границе, не дают
+// "разрезанных" между двумя строками кэша загрузок при последовательном обходе
+inline constexpr size_t kCacheLineSize = 64;
+
+// Аллокатор, выравнивающий начало каждого буфера по границе Alignment байт (но не меньше alignof(T)).
+// Позволяет, например, читать элементы Vector<float> выровненными AVX-загрузками
+template <typename T, size_t Alignment = kCacheLineSize>
+class AlignedAllocator {
+    static_assert((Alignment & (Alignment - 1)) == 0, "Alignment must be a power of two");
+
+public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    static constexpr size_t kAlignment = std::max(Alignment, alignof(T));
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() noexcept = default;
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        if (n > static_cast<size_t>(-1) / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return static_cast<T*>(operator new(n * sizeof(T), std::align_val_t{kAlignment}));
+    }
+
+    void deallocate(T* buf, size_t n) noexcept {
+        operator delete(buf, n * sizeof(T), std::align_val_t{kAlignment});
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment>&) const noexcept {
+        return false;
+    }
+};
 
+// Аллокатор может дополнительно предоставлять методы для роста блока без ручного переноса элементов:
+//   bool try_expand(T* buf, size_t old_n, size_t new_n) - расширяет блок на месте, если это возможно;
+//   T* reallocate(T* buf, size_t old_n, size_t new_n) - изменяет размер блока, возможно перенося его
+//       побайтово (как realloc, который для больших блоков сводится к mremap без копирования памяти).
+// Vector пользуется ими только для побайтово переносимых типов
+template <typename Alloc, typename = void>
+struct HasTryExpand : std::false_type {};
+
+template <typename Alloc>
+struct HasTryExpand<Alloc, std::void_t<decltype(std::declval<Alloc&>().try_expand(
+    std::declval<typename Alloc::value_type*>(), size_t{}, size_t{}))>> : std::true_type {};
+
+template <typename Alloc, typename = void>
+struct HasReallocate : std::false_type {};
+
+template <typename Alloc>
+struct HasReallocate<Alloc, std::void_t<decltype(std::declval<Alloc&>().reallocate(
+    std::declval<typename Alloc::value_type*>(), size_t{}, size_t{}))>> : std::true_type {};
+
+// Аллокатор поверх malloc/realloc/free. Vector с этим аллокатором растёт через realloc
 template <typename T>
-class RawMemory {
+class MallocAllocator {
+    static_assert(alignof(T) <= alignof(std::max_align_t), "malloc cannot provide over-aligned storage");
+
+public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    MallocAllocator() noexcept = default;
+
+    template <typename U>
+    MallocAllocator(const MallocAllocator<U>&) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        if (n > static_cast<size_t>(-1) / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        void* buf = std::malloc(n * sizeof(T));
+        if (buf == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(buf);
+    }
+
+    void deallocate(T* buf, size_t /*n*/) noexcept {
+        std::free(buf);
+    }
+
+    // При нехватке памяти выбрасывает std::bad_alloc, оставляя исходный блок нетронутым
+    T* reallocate(T* buf, size_t /*old_n*/, size_t new_n) {
+        if (new_n > static_cast<size_t>(-1) / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        void* new_buf = std::realloc(buf, new_n * sizeof(T));
+        if (new_buf == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(new_buf);
+    }
+
+    template <typename U>
+    bool operator==(const MallocAllocator<U>&) const noexcept {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const MallocAllocator<U>&) const noexcept {
+        return false;
+    }
+};
+
+// Аллокатор хранится как приватная база, поэтому аллокатор без состояния
+// (например, std::allocator) не увеличивает размер RawMemory
+template <typename T, typename Alloc = std::allocator<T>>
+class RawMemory : private Alloc {
+    using AllocTraits = std::allocator_traits<Alloc>;
+
+    static_assert(std::is_same_v<typename AllocTraits::value_type, T>,
+                  "Alloc::value_type must be the same as T");
+    static_assert(std::is_same_v<typename AllocTraits::pointer, T*>,
+                  "Alloc must use raw pointers");
+
 public:
-    RawMemory() = default;
+    using allocator_type = Alloc;
+
+    VECTOR_CONSTEXPR RawMemory() = default;
+
+    VECTOR_CONSTEXPR explicit RawMemory(const Alloc& alloc) noexcept
+        : Alloc(alloc) {
+    }
 
     RawMemory(const RawMemory&) = delete;
     RawMemory& operator=(const RawMemory& rhs) = delete;
 
-    RawMemory(RawMemory&& other) noexcept
-        : buffer_(std::move(other.GetAddress()))
-        , capacity_(other.Capacity())
+    VECTOR_CONSTEXPR RawMemory(RawMemory&& other) noexcept
+        : Alloc(std::move(other.GetAllocator()))
+        , buffer_(std::exchange(other.buffer_, nullptr))
+        , capacity_(std::exchange(other.capacity_, 0))
     {}
 
-    RawMemory& operator=(RawMemory&& rhs) noexcept
+    VECTOR_CONSTEXPR RawMemory& operator=(RawMemory&& rhs) noexcept
     {
-        buffer_ = std::move(rhs.GetAddress());
-        capacity_ = rhs.Capacity();
+        if (this != &rhs)
+        {
+            Deallocate(buffer_, capacity_);
+            buffer_ = nullptr;
+            capacity_ = 0;
+            Swap(rhs);
+        }
         return *this;
     }
 
-    explicit RawMemory(size_t capacity)
-        : buffer_(Allocate(capacity))
+    VECTOR_CONSTEXPR explicit RawMemory(size_t capacity, const Alloc& alloc = Alloc())
+        : Alloc(alloc)
+        , buffer_(Allocate(capacity))
         , capacity_(capacity) {
     }
 
-    ~RawMemory() {
-        Deallocate(buffer_);
+    VECTOR_CONSTEXPR ~RawMemory() {
+        Deallocate(buffer_, capacity_);
     }
 
-    T* operator+(size_t offset) noexcept {
+    VECTOR_CONSTEXPR T* operator+(size_t offset) noexcept {
         // Разрешается получать адрес ячейки памяти, следующей за последним элементом массива
         assert(offset <= capacity_);
+        VECTOR_HARDENED_CHECK(offset <= capacity_, "offset is out of buffer");
         return buffer_ + offset;
     }
 
-    const T* operator+(size_t offset) const noexcept {
+    VECTOR_CONSTEXPR const T* operator+(size_t offset) const noexcept {
         return const_cast<RawMemory&>(*this) + offset;
     }
 
-    const T& operator[](size_t index) const noexcept {
+    VECTOR_CONSTEXPR const T& operator[](size_t index) const noexcept {
         return const_cast<RawMemory&>(*this)[index];
     }
 
-    T& operator[](size_t index) noexcept {
-        assert(index < capacity_);
-        return buffer_[index];
-    }
+    VECTOR_CONSTEXPR T& operator[](size_t index) noexcept {
+        assert(index < capacity_);
+        VECTOR_HARDENED_CHECK(index < capacity_, "index is out of buffer");
+        return buffer_[index];
+    }
+
+    // Обменивается с other буфером вместе с аллокатором, которым этот буфер был выделен
+    VECTOR_CONSTEXPR void Swap(RawMemory& other) noexcept {
+        using std::swap;
+        swap(GetAllocator(), other.GetAllocator());
+        std::swap(buffer_, other.buffer_);
+        std::swap(capacity_, other.capacity_);
+    }
+
+    VECTOR_CONSTEXPR const T* GetAddress() const noexcept {
+        return buffer_;
+    }
+
+    VECTOR_CONSTEXPR T* GetAddress() noexcept {
+        return buffer_;
+    }
+
+    VECTOR_CONSTEXPR size_t Capacity() const {
+        return capacity_;
+    }
+
+    VECTOR_CONSTEXPR Alloc& GetAllocator() noexcept {
+        return *this;
+    }
+
+    VECTOR_CONSTEXPR const Alloc& GetAllocator() const noexcept {
+        return *this;
+    }
+
+    // Увеличивает ёмкость до new_capacity, побайтово сохраняя первые used элементов буфера.
+    // Сначала пробует расширить блок на месте (try_expand), затем reallocate аллокатора,
+    // иначе выделяет новый блок и копирует в него байты старого.
+    // Подходит только для буферов с побайтово переносимыми элементами
+    VECTOR_CONSTEXPR void Reallocate(size_t new_capacity, size_t used) {
+        assert(new_capacity >= capacity_ && used <= capacity_);
+        if (buffer_ == nullptr) {
+            buffer_ = Allocate(new_capacity);
+            capacity_ = new_capacity;
+            return;
+        }
+
+        VECTOR_STATS_RECORD(VectorEvent::kReallocate, used);
+
+        // Выросший на месте блок остаётся тем же выделением: учитывается только прирост байт
+        if constexpr (HasTryExpand<Alloc>::value) {
+            if (GetAllocator().try_expand(buffer_, capacity_, new_capacity)) {
+                VECTOR_STATS_RECORD(VectorEvent::kResize, (new_capacity - capacity_) * sizeof(T));
+                capacity_ = new_capacity;
+                return;
+            }
+        }
+
+        if constexpr (HasReallocate<Alloc>::value) {
+            buffer_ = GetAllocator().reallocate(buffer_, capacity_, new_capacity);
+            VECTOR_STATS_RECORD(VectorEvent::kResize, (new_capacity - capacity_) * sizeof(T));
+            capacity_ = new_capacity;
+        } else {
+            RawMemory new_memory(new_capacity, GetAllocator());
+            std::memcpy(static_cast<void*>(new_memory.buffer_), static_cast<const void*>(buffer_), used * sizeof(T));
+            VECTOR_STATS_RECORD(VectorEvent::kRelocate, used * sizeof(T));
+            Swap(new_memory);
+        }
+    }
+
+private:
+    // Выделяет сырую память под n элементов и возвращает указатель на неё
+    VECTOR_CONSTEXPR T* Allocate(size_t n) {
+        if (n == 0) {
+            return nullptr;
+        }
+        T* buf = AllocTraits::allocate(GetAllocator(), n);
+        VECTOR_STATS_RECORD(VectorEvent::kAllocate, n * sizeof(T));
+        return buf;
+    }
+
+    // Освобождает сырую память под n элементов, выделенную ранее по адресу buf при помощи Allocate
+    VECTOR_CONSTEXPR void Deallocate(T* buf, size_t n) noexcept {
+        if (buf != nullptr) {
+            VECTOR_STATS_RECORD(VectorEvent::kDeallocate, n * sizeof(T));
+            AllocTraits::deallocate(GetAllocator(), buf, n);
+        }
+    }
+
+    T* buffer_ = nullptr;
+    size_t capacity_ = 0;
+};
+
+// Политики роста определяют ёмкость буфера при реаллокации.
+// NextCapacity получает текущую ёмкость, минимально необходимую ёмкость и размер элемента
+// и должна вернуть значение не меньше required
+
+// Удваивает ёмкость: 1, 2, 4, 8, ...
+struct DoublingGrowth {
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t /*element_size*/) noexcept {
+        return std::max(required, capacity == 0 ? size_t{1} : capacity * 2);
+    }
+};
+
+// Умножает ёмкость на Num / Den. Множитель 3/2 оставляет меньше неиспользуемой памяти,
+// чем удвоение, ценой более частых реаллокаций
+template <size_t Num, size_t Den>
+struct GrowthFactor {
+    static_assert(Num > Den && Den > 0, "Growth factor must be greater than 1");
+
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t /*element_size*/) noexcept {
+        const size_t grown = capacity / Den * Num + capacity % Den * Num / Den;
+        return std::max(required, std::max(grown, capacity + 1));
+    }
+};
+
+// Не даёт первой реаллокации выделить меньше одной строки кэша, избавляя короткие
+// векторы от цепочки выделений 1, 2, 4, ... элемента
+template <typename Base = DoublingGrowth>
+struct CacheLineMinimumGrowth {
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t element_size) noexcept {
+        const size_t min_capacity = std::max(kCacheLineSize / element_size, size_t{1});
+        return std::max(Base::NextCapacity(capacity, required, element_size), min_capacity);
+    }
+};
+
+// Округляет размер буфера в байтах вверх до классов размеров, которыми оперируют
+// распространённые аллокаторы (jemalloc, tcmalloc): четыре класса на каждую степень двойки.
+// Память, которую аллокатор всё равно выделил бы, становится доступной ёмкостью вектора
+template <typename Base = DoublingGrowth>
+struct SizeClassGrowth {
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t element_size) noexcept {
+        const size_t base = Base::NextCapacity(capacity, required, element_size);
+        if (base > static_cast<size_t>(-1) / 2 / element_size) {
+            return base;
+        }
+        return std::max(base, RoundUpToSizeClass(base * element_size) / element_size);
+    }
+
+    static constexpr size_t RoundUpToSizeClass(size_t bytes) noexcept {
+        const size_t kQuantum = 16;
+        if (bytes <= 8 * kQuantum) {
+            return (bytes + kQuantum - 1) / kQuantum * kQuantum;
+        }
+        size_t power = 8 * kQuantum;
+        while (power * 2 < bytes) {
+            power *= 2;
+        }
+        // bytes лежит в (power, 2 * power], шаг классов в этом диапазоне равен power / 4
+        const size_t step = power / 4;
+        return (bytes + step - 1) / step * step;
+    }
+};
+
+// Непрерывный участок из size элементов, начинающийся с data
+template <typename T>
+class Span
+{
+public:
+
+    Span(T* data, size_t size) noexcept
+        : data_(data)
+        , size_(size)
+    {
+    }
+
+    T* begin() const noexcept
+    {
+        return data_;
+    }
+
+    T* end() const noexcept
+    {
+        return data_ + size_;
+    }
+
+    T* Data() const noexcept
+    {
+        return data_;
+    }
+
+    size_t Size() const noexcept
+    {
+        return size_;
+    }
+
+    T& operator[](size_t index) const noexcept
+    {
+        assert(index < size_);
+        return data_[index];
+    }
+
+private:
+
+    T* data_;
+    size_t size_;
+};
+
+#ifdef ADVANCED_VECTOR_HARDENED
+// Итератор усиленного режима. Помнит вектор owner и поколение его буфера на момент создания.
+// Разыменование проверяет, что буфер не реаллоцировался и итератор указывает на элемент,
+// а сравнение и разность - что оба итератора принадлежат одному вектору.
+// Container должен предоставлять Data(), Size() и IteratorGeneration()
+template <typename T, typename Container>
+class CheckedIterator
+{
+public:
+
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = std::remove_const_t<T>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = T*;
+    using reference = T&;
+
+    VECTOR_CONSTEXPR CheckedIterator() = default;
+
+    VECTOR_CONSTEXPR CheckedIterator(T* ptr, const Container* owner) noexcept
+        : ptr_(ptr)
+        , owner_(owner)
+        , generation_(owner->IteratorGeneration())
+    {
+    }
+
+    // Неконстантный итератор преобразуется в константный
+    template <typename U, typename = std::enable_if_t<std::is_same_v<const U, T> && !std::is_same_v<U, T>>>
+    VECTOR_CONSTEXPR CheckedIterator(const CheckedIterator<U, Container>& other) noexcept
+        : ptr_(other.ptr_)
+        , owner_(other.owner_)
+        , generation_(other.generation_)
+    {
+    }
+
+    // true, если буфер вектора не менялся и итератор указывает на один из его элементов
+    VECTOR_CONSTEXPR bool IsDereferenceable() const noexcept
+    {
+        return IsValid() && ptr_ != owner_->Data() + owner_->Size();
+    }
+
+    // true, если буфер вектора не менялся и итератор лежит в [begin(), end()]
+    VECTOR_CONSTEXPR bool IsValid() const noexcept
+    {
+        return owner_ != nullptr && generation_ == owner_->IteratorGeneration() && owner_->Data() <= ptr_
+            && ptr_ <= owner_->Data() + owner_->Size();
+    }
+
+    VECTOR_CONSTEXPR reference operator*() const noexcept
+    {
+        VECTOR_HARDENED_CHECK(IsDereferenceable(), "dereferencing an invalid iterator");
+        return *ptr_;
+    }
+
+    VECTOR_CONSTEXPR pointer operator->() const noexcept
+    {
+        return &**this;
+    }
+
+    VECTOR_CONSTEXPR reference operator[](difference_type offset) const noexcept
+    {
+        return *(*this + offset);
+    }
+
+    VECTOR_CONSTEXPR CheckedIterator& operator++() noexcept
+    {
+        return *this += 1;
+    }
+
+    VECTOR_CONSTEXPR CheckedIterator operator++(int) noexcept
+    {
+        CheckedIterator it = *this;
+        ++*this;
+        return it;
+    }
+
+    VECTOR_CONSTEXPR CheckedIterator& operator--() noexcept
+    {
+        return *this -= 1;
+    }
+
+    VECTOR_CONSTEXPR CheckedIterator operator--(int) noexcept
+    {
+        CheckedIterator it = *this;
+        --*this;
+        return it;
+    }
+
+    VECTOR_CONSTEXPR CheckedIterator& operator+=(difference_type offset) noexcept
+    {
+        VECTOR_HARDENED_CHECK(IsValid(), "moving an invalid iterator");
+        VECTOR_HARDENED_CHECK(offset >= owner_->Data() - ptr_ && offset <= owner_->Data() + owner_->Size() - ptr_,
+                              "moving an iterator out of range");
+        ptr_ += offset;
+        return *this;
+    }
+
+    VECTOR_CONSTEXPR CheckedIterator& operator-=(difference_type offset) noexcept
+    {
+        return *this += -offset;
+    }
+
+    friend VECTOR_CONSTEXPR CheckedIterator operator+(CheckedIterator it, difference_type offset) noexcept
+    {
+        return it += offset;
+    }
+
+    friend VECTOR_CONSTEXPR CheckedIterator operator+(difference_type offset, CheckedIterator it) noexcept
+    {
+        return it += offset;
+    }
+
+    friend VECTOR_CONSTEXPR CheckedIterator operator-(CheckedIterator it, difference_type offset) noexcept
+    {
+        return it -= offset;
+    }
+
+    friend VECTOR_CONSTEXPR difference_type operator-(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept
+    {
+        CheckComparable(lhs, rhs);
+        return lhs.ptr_ - rhs.ptr_;
+    }
+
+    friend VECTOR_CONSTEXPR bool operator==(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept
+    {
+        CheckComparable(lhs, rhs);
+        return lhs.ptr_ == rhs.ptr_;
+    }
+
+    friend VECTOR_CONSTEXPR bool operator!=(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept
+    {
+        return !(lhs == rhs);
+    }
+
+    friend VECTOR_CONSTEXPR bool operator<(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept
+    {
+        CheckComparable(lhs, rhs);
+        return lhs.ptr_ < rhs.ptr_;
+    }
+
+    friend VECTOR_CONSTEXPR bool operator>(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept
+    {
+        return rhs < lhs;
+    }
+
+    friend VECTOR_CONSTEXPR bool operator<=(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept
+    {
+        return !(rhs < lhs);
+    }
+
+    friend VECTOR_CONSTEXPR bool operator>=(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept
+    {
+        return !(lhs < rhs);
+    }
+
+private:
+
+    template <typename U, typename OtherContainer>
+    friend class CheckedIterator;
+
+    // Итераторы, созданные по умолчанию, сравнимы только между собой
+    static VECTOR_CONSTEXPR void CheckComparable(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept
+    {
+        VECTOR_HARDENED_CHECK(lhs.owner_ == rhs.owner_, "comparing iterators of different vectors");
+        VECTOR_HARDENED_CHECK(lhs.owner_ == nullptr || (lhs.IsValid() && rhs.IsValid()),
+                              "comparing invalid iterators");
+    }
+
+    T* ptr_ = nullptr;
+    const Container* owner_ = nullptr;
+    size_t generation_ = 0;
+};
+#endif
+
+template <typename T, typename Alloc = std::allocator<T>, typename Growth = DoublingGrowth>
+class Vector;
+
+// Тег для конструктора и методов Vector, создающих элементы инициализацией по умолчанию:
+// элементы тривиальных типов (int, POD-структуры) остаются незаполненными
+struct DefaultInitTag {
+    explicit DefaultInitTag() = default;
+};
+
+inline constexpr DefaultInitTag kDefaultInit{};
+
+// Правка для Vector::ApplyEdits: удаляет erase_count элементов начиная с индекса position
+// и вставляет на их место insert_count копий элементов массива values.
+// Индексы относятся к вектору до применения правок
+template <typename T>
+struct VectorEdit
+{
+    static constexpr VectorEdit Insert(size_t position, const T& value) noexcept
+    {
+        return {position, 0, &value, 1};
+    }
+
+    static constexpr VectorEdit Insert(size_t position, const T* values, size_t count) noexcept
+    {
+        return {position, 0, values, count};
+    }
+
+    static constexpr VectorEdit Erase(size_t position, size_t count = 1) noexcept
+    {
+        return {position, count, nullptr, 0};
+    }
+
+    size_t position = 0;
+    size_t erase_count = 0;
+    const T* values = nullptr;
+    size_t insert_count = 0;
+};
+
+// Операции над элементами в сырой памяти, общие для Vector и SmallVector: конструирование
+// и разрушение через аллокатор, перенос элементов в новый буфер и вставка со сдвигом хвоста.
+// Владение буфером остаётся за контейнером, а операции получают его аллокатор и адреса элементов
+template <typename T, typename Alloc>
+class ElementOps
+{
+protected:
+
+    using AllocTraits = std::allocator_traits<Alloc>;
+
+    // Для std::allocator construct/destroy сводятся к placement new и вызову деструктора,
+    // поэтому можно пользоваться оптимизированными алгоритмами из <memory>
+    static constexpr bool kIsStdAllocator = std::is_same_v<Alloc, std::allocator<T>>;
+
+    template <typename... Args>
+    static VECTOR_CONSTEXPR void ConstructAt(Alloc& alloc, T* place, Args&&... args)
+    {
+        AllocTraits::construct(alloc, place, std::forward<Args>(args)...);
+    }
+
+    static VECTOR_CONSTEXPR void DestroyAt(Alloc& alloc, T* place) noexcept
+    {
+        AllocTraits::destroy(alloc, place);
+    }
+
+    static VECTOR_CONSTEXPR void DestroyN(Alloc& alloc, T* first, size_t n) noexcept
+    {
+        if constexpr (kIsStdAllocator)
+        {
+#ifdef ADVANCED_VECTOR_PARALLEL
+            if constexpr (!std::is_trivially_destructible_v<T>)
+            {
+                if (!IsConstantEvaluated() && ShouldRunInParallel(n))
+                {
+                    ParallelForChunks(n, [first](size_t from, size_t count) noexcept {
+                        std::destroy_n(first + from, count);
+                    });
+                    return;
+                }
+            }
+#endif
+            std::destroy_n(first, n);
+        }
+        else
+        {
+            for (size_t i = 0; i != n; ++i)
+            {
+                DestroyAt(alloc, first + i);
+            }
+        }
+    }
+
+    // Конструирует n элементов по адресу to, вызывая construct(place, i) для каждой ячейки.
+    // Если конструирование какого-либо элемента выбросит исключение, уже созданные элементы разрушаются
+    template <typename Construct>
+    static VECTOR_CONSTEXPR void UninitializedConstructN(Alloc& alloc, T* to, size_t n, Construct construct)
+    {
+        size_t i = 0;
+        try
+        {
+            for (; i != n; ++i)
+            {
+                construct(to + i, i);
+            }
+        }
+        catch (...)
+        {
+            DestroyN(alloc, to, i);
+            throw;
+        }
+    }
+
+    static VECTOR_CONSTEXPR void UninitializedValueConstructN(Alloc& alloc, T* to, size_t n)
+    {
+        if constexpr (kIsStdAllocator)
+        {
+            if (!IsConstantEvaluated())
+            {
+#ifdef ADVANCED_VECTOR_PARALLEL
+                if (ShouldRunInParallel(n))
+                {
+                    ParallelForChunks(n,
+                        [to](size_t from, size_t count) { std::uninitialized_value_construct_n(to + from, count); },
+                        [to](size_t from, size_t count) noexcept { std::destroy_n(to + from, count); });
+                    return;
+                }
+#endif
+                std::uninitialized_value_construct_n(to, n);
+                return;
+            }
+        }
+        UninitializedConstructN(alloc, to, n, [&alloc](T* place, size_t) { ConstructAt(alloc, place); });
+    }
+
+    template <typename InputIt>
+    static VECTOR_CONSTEXPR void UninitializedCopyN(Alloc& alloc, InputIt from, size_t n, T* to)
+    {
+        if constexpr (kIsStdAllocator)
+        {
+            if (!IsConstantEvaluated())
+            {
+#ifdef ADVANCED_VECTOR_PARALLEL
+                if constexpr (std::is_pointer_v<InputIt>)
+                {
+                    if (ShouldRunInParallel(n))
+                    {
+                        ParallelForChunks(n,
+                            [from, to](size_t first, size_t count) { std::uninitialized_copy_n(from + first, count, to + first); },
+                            [to](size_t first, size_t count) noexcept { std::destroy_n(to + first, count); });
+                        return;
+                    }
+                }
+#endif
+                std::uninitialized_copy_n(from, n, to);
+                return;
+            }
+        }
+        UninitializedConstructN(alloc, to, n, [&alloc, &from](T* place, size_t) {
+            ConstructAt(alloc, place, *from);
+            ++from;
+        });
+    }
+
+    // Перемещает (или копирует, если перемещение может выбросить исключение) n элементов
+    // из from в неинициализированную память to. Исходные элементы не разрушаются
+    static VECTOR_CONSTEXPR void UninitializedMoveOrCopyN(Alloc& alloc, T* from, size_t n, T* to)
+    {
+        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>)
+        {
+            if (kIsStdAllocator && !IsConstantEvaluated())
+            {
+                std::uninitialized_move_n(from, n, to);
+            }
+            else
+            {
+                UninitializedConstructN(alloc, to, n, [&alloc, from](T* place, size_t i) {
+                    ConstructAt(alloc, place, std::move(from[i]));
+                });
+            }
+            VECTOR_STATS_RECORD(VectorEvent::kMove, n);
+        }
+        else
+        {
+            UninitializedCopyN(alloc, from, n, to);
+            VECTOR_STATS_RECORD(VectorEvent::kCopy, n);
+        }
+    }
+
+    // Побайтовый перенос элементов невозможен при константном вычислении
+    static constexpr bool CanRelocate() noexcept
+    {
+        return IsTriviallyRelocatableV<T> && !IsConstantEvaluated();
+    }
+
+    // Побайтово переносит n элементов из from в неинициализированную память to.
+    // После переноса элементы по адресу from считаются разрушенными
+    static void Relocate(T* from, size_t n, T* to) noexcept
+    {
+        assert(CanRelocate());
+        if (n != 0)
+        {
+            std::memcpy(static_cast<void*>(to), static_cast<const void*>(from), n * sizeof(T));
+            VECTOR_STATS_RECORD(VectorEvent::kRelocate, n * sizeof(T));
+        }
+    }
+
+    // Побайтово переносит n элементов из from в to, допуская перекрытие областей
+    static void RelocateOverlapping(T* from, size_t n, T* to) noexcept
+    {
+        assert(CanRelocate());
+        if (n != 0)
+        {
+            std::memmove(static_cast<void*>(to), static_cast<const void*>(from), n * sizeof(T));
+            VECTOR_STATS_RECORD(VectorEvent::kRelocate, n * sizeof(T));
+        }
+    }
+
+    // Переносит size элементов из from в неинициализированную память to и разрушает исходные.
+    // Если перенос выбросит исключение, элементы from остаются нетронутыми
+    static VECTOR_CONSTEXPR void MoveOrCopyAll(Alloc& alloc, T* from, size_t size, T* to)
+    {
+        if (CanRelocate())
+        {
+            Relocate(from, size, to);
+        }
+        else
+        {
+            UninitializedMoveOrCopyN(alloc, from, size, to);
+            DestroyN(alloc, from, size);
+        }
+    }
+
+    // Переносит size элементов из from в неинициализированную память to, оставляя в ней
+    // count свободных ячеек начиная с индекса offset, и разрушает исходные элементы.
+    // Если перенос выбросит исключение, элементы from остаются нетронутыми
+    static VECTOR_CONSTEXPR void MoveOrCopyAllWithGap(Alloc& alloc, T* from, size_t size, T* to, size_t offset,
+                                                      size_t count)
+    {
+        const size_t tail = size - offset;
+        if (CanRelocate())
+        {
+            Relocate(from, offset, to);
+            Relocate(from + offset, tail, to + (offset + count));
+            return;
+        }
+
+        UninitializedMoveOrCopyN(alloc, from, offset, to);
+        try
+        {
+            UninitializedMoveOrCopyN(alloc, from + offset, tail, to + (offset + count));
+        }
+        catch (...)
+        {
+            DestroyN(alloc, to, offset);
+            throw;
+        }
+        DestroyN(alloc, from, size);
+    }
+
+    // Возвращает true, если объект arg расположен внутри одного из size элементов по адресу data.
+    // При константном вычислении адреса несвязанных объектов сравнивать нельзя,
+    // поэтому считается, что arg может быть элементом
+    template <typename Arg>
+    static VECTOR_CONSTEXPR bool IsInsideElements(const Arg& arg, const T* data, size_t size) noexcept
+    {
+        if (IsConstantEvaluated())
+        {
+            return true;
+        }
+        const void* address = std::addressof(arg);
+        const std::less<const void*> less;
+        return !less(address, data) && less(address, data + size);
+    }
+
+    // Конструирует новый элемент на позиции offset среди size элементов по адресу data,
+    // когда за ними есть свободная ячейка.
+    // Последний элемент перемещается в свободную ячейку за концом, остальные сдвигаются
+    // присваиванием, а новый элемент конструируется сразу на своём месте.
+    // Временный объект нужен, только если аргументы ссылаются на элементы
+    // или если без него нельзя откатить сдвиг при исключении
+    template <typename... Args>
+    static VECTOR_CONSTEXPR void EmplaceNoAllocation(Alloc& alloc, T* data, size_t size, size_t offset, Args&&... args)
+    {
+        T* slot = data + offset;
+        T* old_end = data + size;
+
+        if (slot == old_end)
+        {
+            ConstructAt(alloc, slot, std::forward<Args>(args)...);
+            return;
+        }
+
+        VECTOR_STATS_RECORD(VectorEvent::kShiftingEmplace, size - offset);
+
+        constexpr bool kCanRollBack = std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_assignable_v<T>;
+
+        if (kCanRollBack && !(false || ... || IsInsideElements(args, data, size)))
+        {
+            ConstructAt(alloc, old_end, std::move(*(old_end - 1)));
+            std::move_backward(slot, old_end - 1, old_end);
+            DestroyAt(alloc, slot);
+            try
+            {
+                ConstructAt(alloc, slot, std::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                // Возвращаем хвост на место, чтобы элементы остались в исходном состоянии
+                ConstructAt(alloc, slot, std::move(*(slot + 1)));
+                std::move(slot + 2, old_end + 1, slot + 1);
+                DestroyAt(alloc, old_end);
+                throw;
+            }
+        }
+        else
+        {
+            T tmp(std::forward<Args>(args)...);
+            ConstructAt(alloc, old_end, std::move(*(old_end - 1)));
+            std::move_backward(slot, old_end - 1, old_end);
+            *slot = std::move(tmp);
+        }
+    }
+};
+
+// Вектор, буфер которого начинается на границе Alignment байт
+template <typename T, size_t Alignment = kCacheLineSize>
+using AlignedVector = Vector<T, AlignedAllocator<T, Alignment>>;
+
+template <typename T, typename Alloc, typename Growth>
+class Vector : private ElementOps<T, Alloc>
+{
+    using Ops = ElementOps<T, Alloc>;
+    using typename Ops::AllocTraits;
+    using Ops::kIsStdAllocator;
+    using Ops::CanRelocate;
+    using Ops::Relocate;
+    using Ops::RelocateOverlapping;
+
+    // Буфер побайтово переносимых элементов можно наращивать средствами самого аллокатора
+    static constexpr bool kCanGrowInPlace = IsTriviallyRelocatableV<T>
+        && (HasTryExpand<Alloc>::value || HasReallocate<Alloc>::value);
+
+public:
+
+    using allocator_type = Alloc;
+
+    VECTOR_CONSTEXPR Vector() = default;
+
+    VECTOR_CONSTEXPR explicit Vector(const Alloc& alloc) noexcept
+        : data_(alloc)
+    {
+    }
+
+    VECTOR_CONSTEXPR Vector(Vector&& other) noexcept
+        : data_(std::move(other.data_))
+        , size_(std::exchange(other.size_, 0))
+    {
+    }
+
+    VECTOR_CONSTEXPR explicit Vector(size_t size, const Alloc& alloc = Alloc())
+        : data_(size, alloc)
+        , size_(size)
+    {
+        UninitializedValueConstructN(data_.GetAddress(), size);
+    }
+
+    // Создаёт вектор из size элементов, не заполняя память элементов тривиальных типов.
+    // Удобно, когда буфер сразу будет перезаписан, например, при чтении из файла
+    VECTOR_CONSTEXPR Vector(size_t size, DefaultInitTag, const Alloc& alloc = Alloc())
+        : data_(size, alloc)
+        , size_(size)
+    {
+        UninitializedDefaultConstructN(data_.GetAddress(), size);
+    }
+
+    VECTOR_CONSTEXPR Vector(const Vector& other)
+        : data_(other.size_, AllocTraits::select_on_container_copy_construction(other.data_.GetAllocator()))
+        , size_(other.size_)  //
+    {
+        UninitializedCopyN(other.data_.GetAddress(), size_, data_.GetAddress());
+    }
+
+#ifdef ADVANCED_VECTOR_HARDENED
+    using iterator = CheckedIterator<T, Vector>;
+    using const_iterator = CheckedIterator<const T, Vector>;
+#else
+    using iterator = T*;
+    using const_iterator = const T*;
+#endif
+
+    VECTOR_CONSTEXPR iterator begin() noexcept
+    {
+        return MakeIterator(data_.GetAddress());
+    }
+
+    VECTOR_CONSTEXPR iterator end() noexcept
+    {
+        return MakeIterator(data_.GetAddress() + size_);
+    }
+
+    VECTOR_CONSTEXPR const_iterator begin() const noexcept
+    {
+        return MakeIterator(data_.GetAddress());
+    }
+
+    VECTOR_CONSTEXPR const_iterator end() const noexcept
+    {
+        return MakeIterator(data_.GetAddress() + size_);
+    }
+
+    VECTOR_CONSTEXPR const_iterator cbegin() const noexcept
+    {
+        return begin();
+    }
+
+    VECTOR_CONSTEXPR const_iterator cend() const noexcept
+    {
+        return end();
+    }
+
+    VECTOR_CONSTEXPR Alloc GetAllocator() const noexcept
+    {
+        return data_.GetAllocator();
+    }
+
+    //###EMPLACE() DEPENDENCIES START#####
+    private:
+
+    template <typename... Args>
+    VECTOR_CONSTEXPR void ConstructAt(T* place, Args&&... args)
+    {
+        Ops::ConstructAt(data_.GetAllocator(), place, std::forward<Args>(args)...);
+    }
+
+    VECTOR_CONSTEXPR void DestroyAt(T* place) noexcept
+    {
+        Ops::DestroyAt(data_.GetAllocator(), place);
+    }
+
+    VECTOR_CONSTEXPR void DestroyN(T* first, size_t n) noexcept
+    {
+        Ops::DestroyN(data_.GetAllocator(), first, n);
+    }
+
+    VECTOR_CONSTEXPR void UninitializedValueConstructN(T* to, size_t n)
+    {
+        Ops::UninitializedValueConstructN(data_.GetAllocator(), to, n);
+    }
+
+    // Для тривиально конструируемых по умолчанию типов память не заполняется.
+    // Остальные типы (и все типы при константном вычислении, где нельзя оставить память
+    // незаполненной) конструируются через аллокатор конструктором по умолчанию
+    VECTOR_CONSTEXPR void UninitializedDefaultConstructN(T* to, size_t n)
+    {
+        if constexpr (std::is_trivially_default_constructible_v<T>)
+        {
+            if (!IsConstantEvaluated())
+            {
+                std::uninitialized_default_construct_n(to, n);
+                return;
+            }
+        }
+        UninitializedValueConstructN(to, n);
+    }
+
+    template <typename InputIt>
+    VECTOR_CONSTEXPR void UninitializedCopyN(InputIt from, size_t n, T* to)
+    {
+        Ops::UninitializedCopyN(data_.GetAllocator(), from, n, to);
+    }
+
+    // Присваивает n элементам по адресу to значения элементов по адресу from
+    static VECTOR_CONSTEXPR void CopyAssignN(const T* from, size_t n, T* to)
+    {
+#ifdef ADVANCED_VECTOR_PARALLEL
+        if (kIsStdAllocator && !IsConstantEvaluated() && ShouldRunInParallel(n))
+        {
+            ParallelForChunks(n, [from, to](size_t first, size_t count) {
+                std::copy_n(from + first, count, to + first);
+            });
+            return;
+        }
+#endif
+        std::copy_n(from, n, to);
+    }
+
+    VECTOR_CONSTEXPR void UninitializedFillN(T* to, size_t n, const T& value)
+    {
+        if constexpr (kIsStdAllocator)
+        {
+            if (!IsConstantEvaluated())
+            {
+                std::uninitialized_fill_n(to, n, value);
+                return;
+            }
+        }
+        Ops::UninitializedConstructN(data_.GetAllocator(), to, n, [this, &value](T* place, size_t) { ConstructAt(place, value); });
+    }
+
+    VECTOR_CONSTEXPR void UninitializedMoveOrCopyN(T* from, size_t n, T* to)
+    {
+        Ops::UninitializedMoveOrCopyN(data_.GetAllocator(), from, n, to);
+    }
+
+    // Ёмкость, которую политика роста выбирает для буфера не меньше чем на required элементов
+    VECTOR_CONSTEXPR size_t GrowCapacity(size_t required) const noexcept
+    {
+        const size_t new_capacity = Growth::NextCapacity(Capacity(), required, sizeof(T));
+        assert(new_capacity >= required);
+        return new_capacity;
+    }
+
+    // Переносит элементы в new_data, оставляя в ней count свободных ячеек начиная с индекса offset,
+    // в которых уже сконструированы новые элементы
+    VECTOR_CONSTEXPR void EmplaceWithAllocation(RawMemory<T, Alloc>& new_data, size_t offset, size_t count = 1)
+    {
+        if (Capacity() != 0)
+        {
+            VECTOR_STATS_RECORD(VectorEvent::kReallocate, size_);
+        }
+        Ops::MoveOrCopyAllWithGap(data_.GetAllocator(), data_.GetAddress(), size_, new_data.GetAddress(), offset, count);
+
+        InvalidateIterators();
+        data_.Swap(new_data);
+    }
+
+    template <typename Arg>
+    VECTOR_CONSTEXPR bool IsInsideElements(const Arg& arg) const noexcept
+    {
+        return Ops::IsInsideElements(arg, Data(), size_);
+    }
+
+    // Конструирует новый элемент на позиции offset, когда ёмкости достаточно
+    template <typename... Args>
+    VECTOR_CONSTEXPR void EmplaceNoAllocation(size_t offset, Args&&... args)
+    {
+        Ops::EmplaceNoAllocation(data_.GetAllocator(), data_.GetAddress(), size_, offset, std::forward<Args>(args)...);
+    }
+
+    // Вставляет count элементов перед позицией offset, сдвигая хвост вектора один раз.
+    // construct(to, first, n) конструирует в неинициализированной памяти to вставляемые элементы
+    // с индексами [first, first + n), assign(to, first, n) присваивает их уже существующим элементам
+    template <typename Construct, typename Assign>
+    VECTOR_CONSTEXPR iterator InsertN(size_t offset, size_t count, Construct construct, Assign assign)
+    {
+        if (count == 0)
+        {
+            return begin() + offset;
+        }
+
+        if constexpr (kCanGrowInPlace)
+        {
+            if (!IsConstantEvaluated() && Capacity() - size_ < count)
+            {
+                InvalidateIterators();
+                data_.Reallocate(GrowCapacity(size_ + count), size_);
+            }
+        }
+
+        if (Capacity() - size_ < count)
+        {
+            RawMemory<T, Alloc> new_data(GrowCapacity(size_ + count), data_.GetAllocator());
+            construct(new_data + offset, 0, count);
+
+            try
+            {
+                EmplaceWithAllocation(new_data, offset, count);
+            }
+            catch (...)
+            {
+                DestroyN(new_data + offset, count);
+                throw;
+            }
+
+            size_ += count;
+            return begin() + offset;
+        }
+
+        const size_t tail = size_ - offset;
+        T* gap = data_ + offset;
+        T* old_end = data_ + size_;
+
+        if (tail != 0)
+        {
+            VECTOR_STATS_RECORD(VectorEvent::kShiftingEmplace, tail);
+        }
+
+        if (CanRelocate())
+        {
+            // Хвост переносится побайтово, а при исключении возвращается на место
+            RelocateOverlapping(gap, tail, gap + count);
+            try
+            {
+                construct(gap, 0, count);
+            }
+            catch (...)
+            {
+                RelocateOverlapping(gap + count, tail, gap);
+                throw;
+            }
+            size_ += count;
+        }
+        else if (tail > count)
+        {
+            UninitializedMoveOrCopyN(old_end - count, count, old_end);
+            size_ += count;
+            std::move_backward(gap, old_end - count, old_end);
+            assign(gap, 0, count);
+        }
+        else
+        {
+            construct(old_end, tail, count - tail);
+            try
+            {
+                UninitializedMoveOrCopyN(gap, tail, old_end + (count - tail));
+            }
+            catch (...)
+            {
+                DestroyN(old_end, count - tail);
+                throw;
+            }
+            size_ += count;
+            assign(gap, 0, tail);
+        }
+
+        return begin() + offset;
+    }
+
+    // Обходит правки по порядку, вызывая keep(from, to, n) для каждого сохраняемого участка
+    // [from, from + n) исходного вектора и place(edit, to) для каждой правки,
+    // где to - индекс участка или вставляемых элементов в результате
+    template <typename EditRange, typename Keep, typename Place>
+    VECTOR_CONSTEXPR void ForEachEditSegment(const EditRange& edits, Keep keep, Place place) const
+    {
+        size_t from = 0;
+        size_t to = 0;
+        for (const VectorEdit<T>& edit : edits)
+        {
+            keep(from, to, edit.position - from);
+            to += edit.position - from;
+            place(edit, to);
+            to += edit.insert_count;
+            from = edit.position + edit.erase_count;
+        }
+        keep(from, to, size_ - from);
+    }
+
+    // Разрушает вставленные элементы первых count правок, собранных в буфере to_data
+    template <typename EditRange>
+    VECTOR_CONSTEXPR void DestroyEditInsertions(const EditRange& edits, T* to_data, size_t count) noexcept
+    {
+        ForEachEditSegment(edits, [](size_t, size_t, size_t) {}, [&](const VectorEdit<T>& edit, size_t to) {
+            if (count != 0)
+            {
+                DestroyN(to_data + to, edit.insert_count);
+                --count;
+            }
+        });
+    }
+
+    // Собирает результат правок в новом буфере. Сначала копируются вставляемые элементы,
+    // и только затем переносятся сохраняемые, поэтому при исключении вектор не меняется
+    template <typename EditRange>
+    VECTOR_CONSTEXPR void ApplyEditsWithAllocation(const EditRange& edits, size_t new_size)
+    {
+        RawMemory<T, Alloc> new_data(GrowCapacity(new_size), data_.GetAllocator());
+        T* to_data = new_data.GetAddress();
+        if (Capacity() != 0)
+        {
+            VECTOR_STATS_RECORD(VectorEvent::kReallocate, size_);
+        }
+
+        size_t inserted_edits = 0;
+        try
+        {
+            ForEachEditSegment(edits, [](size_t, size_t, size_t) {}, [&](const VectorEdit<T>& edit, size_t to) {
+                UninitializedCopyN(edit.values, edit.insert_count, to_data + to);
+                ++inserted_edits;
+            });
+        }
+        catch (...)
+        {
+            DestroyEditInsertions(edits, to_data, inserted_edits);
+            throw;
+        }
+
+        if (CanRelocate())
+        {
+            ForEachEditSegment(edits,
+                [&](size_t from, size_t to, size_t n) { Relocate(data_ + from, n, to_data + to); },
+                [&](const VectorEdit<T>& edit, size_t) { DestroyN(data_ + edit.position, edit.erase_count); });
+        }
+        else
+        {
+            size_t kept_segments = 0;
+            try
+            {
+                ForEachEditSegment(edits, [&](size_t from, size_t to, size_t n) {
+                    UninitializedMoveOrCopyN(data_ + from, n, to_data + to);
+                    ++kept_segments;
+                }, [](const VectorEdit<T>&, size_t) {});
+            }
+            catch (...)
+            {
+                ForEachEditSegment(edits, [&](size_t, size_t to, size_t n) {
+                    if (kept_segments != 0)
+                    {
+                        DestroyN(to_data + to, n);
+                        --kept_segments;
+                    }
+                }, [](const VectorEdit<T>&, size_t) {});
+                DestroyEditInsertions(edits, to_data, static_cast<size_t>(-1));
+                throw;
+            }
+            DestroyN(data_.GetAddress(), size_);
+        }
 
-    void Swap(RawMemory& other) noexcept {
-        std::swap(buffer_, other.buffer_);
-        std::swap(capacity_, other.capacity_);
+        InvalidateIterators();
+        data_.Swap(new_data);
+        size_ = new_size;
     }
 
-    const T* GetAddress() const noexcept {
-        return buffer_;
-    }
+    // Применяет правки на месте за два прохода: первый сдвигает сохраняемые участки влево,
+    // закрывая удалённые, второй от конца раздвигает их вправо под вставляемые элементы.
+    // Базовая гарантия: при исключении вектор остаётся корректным, но часть правок
+    // может быть не применена, а для не переносимых побайтово типов часть элементов потеряна
+    template <typename EditRange>
+    VECTOR_CONSTEXPR void ApplyEditsInPlace(const EditRange& edits, size_t new_size)
+    {
+        // Проход 1: удаление. Сохраняемый участок [from, from + n) переезжает на место compact
+        size_t compact = 0;
+        ForEachEditSegment(edits, [&](size_t from, size_t, size_t n) {
+            if (from != compact)
+            {
+                if (CanRelocate())
+                {
+                    RelocateOverlapping(data_ + from, n, data_ + compact);
+                }
+                else
+                {
+                    std::move(data_ + from, data_ + from + n, data_ + compact);
+                }
+            }
+            compact += n;
+        }, [&](const VectorEdit<T>& edit, size_t) {
+            if (CanRelocate())
+            {
+                DestroyN(data_ + edit.position, edit.erase_count);
+            }
+        });
+        if (!CanRelocate())
+        {
+            DestroyN(data_ + compact, size_ - compact);
+        }
+        size_ = compact;
+
+        // Проход 2: вставка. Ячейки [0, compact) живые, за ними - неинициализированная память.
+        // Назначения заполняются по убыванию индекса, поэтому сконструированные ячейки за compact
+        // всегда образуют отрезок [constructed, new_size)
+        size_t src_end = compact;
+        size_t dst_end = new_size;
+        size_t constructed = new_size;
+        size_t erased_before = 0;
+        for (const VectorEdit<T>& edit : edits)
+        {
+            erased_before += edit.erase_count;
+        }
 
-    T* GetAddress() noexcept {
-        return buffer_;
-    }
+        auto edit = std::end(edits);
+        try
+        {
+            while (dst_end != src_end)
+            {
+                --edit;
+                erased_before -= edit->erase_count;
+                const size_t position = edit->position - erased_before;
+                const size_t kept = src_end - position;
+                const size_t kept_to = dst_end - kept;
+                const size_t insert_to = kept_to - edit->insert_count;
+
+                if (CanRelocate())
+                {
+                    RelocateOverlapping(data_ + position, kept, data_ + kept_to);
+                    size_ = position;
+                    constructed = kept_to;
+                    UninitializedCopyN(edit->values, edit->insert_count, data_ + insert_to);
+                    constructed = insert_to;
+                }
+                else
+                {
+                    // Верхние ячейки назначения конструируются, нижние (живые) присваиваются
+                    const size_t kept_raw = dst_end - std::max(kept_to, std::min(dst_end, compact));
+                    UninitializedMoveOrCopyN(data_ + (src_end - kept_raw), kept_raw, data_ + (dst_end - kept_raw));
+                    constructed = std::max(dst_end - kept_raw, compact);
+                    std::move_backward(data_ + position, data_ + (src_end - kept_raw), data_ + (dst_end - kept_raw));
+
+                    const size_t insert_raw = kept_to - std::max(insert_to, std::min(kept_to, compact));
+                    UninitializedCopyN(edit->values + (edit->insert_count - insert_raw), insert_raw,
+                        data_ + (kept_to - insert_raw));
+                    constructed = std::max(kept_to - insert_raw, compact);
+                    std::copy_n(edit->values, edit->insert_count - insert_raw, data_ + insert_to);
+                }
 
-    size_t Capacity() const {
-        return capacity_;
+                src_end = position;
+                dst_end = insert_to;
+            }
+        }
+        catch (...)
+        {
+            if (CanRelocate())
+            {
+                // Сдвигаем уже расставленный хвост вплотную к нетронутому началу
+                RelocateOverlapping(data_ + constructed, new_size - constructed, data_ + size_);
+                size_ += new_size - constructed;
+            }
+            else
+            {
+                DestroyN(data_ + constructed, new_size - constructed);
+            }
+            throw;
+        }
+        size_ = new_size;
     }
 
-private:
-    // Выделяет сырую память под n элементов и возвращает указатель на неё
-    static T* Allocate(size_t n) {
-        return n != 0 ? static_cast<T*>(operator new(n * sizeof(T))) : nullptr;
-    }
+    public:
+    //###EMPLACE() DEPENDENCIES END#######
 
-    // Освобождает сырую память, выделенную ранее по адресу buf при помощи Allocate
-    static void Deallocate(T* buf) noexcept {
-        operator delete(buf);
-    }
+    template <typename... Args>
+    VECTOR_CONSTEXPR iterator Emplace(const_iterator pos, Args&&... args)
+    {
+        size_t offset = pos - cbegin();
 
-    T* buffer_ = nullptr;
-    size_t capacity_ = 0;
-};
+        if constexpr (kCanGrowInPlace)
+        {
+            // После роста блока ссылки на элементы становятся недействительными,
+            // поэтому аргументы, указывающие внутрь вектора, обрабатываются обычным путём
+            if (!IsConstantEvaluated() && Capacity() <= size_ && !(false || ... || IsInsideElements(args)))
+            {
+                InvalidateIterators();
+                data_.Reallocate(GrowCapacity(size_ + 1), size_);
+            }
+        }
 
-template <typename T>
-class Vector
-{
+        if (Capacity() <= size_)
+        {
+            RawMemory<T, Alloc> new_data(GrowCapacity(size_ + 1), data_.GetAllocator());
+            ConstructAt(new_data + offset, std::forward<Args>(args)...);
 
-public:
+            try
+            {
+                EmplaceWithAllocation(new_data, offset);
+            }
+            catch (...)
+            {
+                DestroyAt(new_data + offset);
+                throw;
+            }
+        }
+        else
+        {
+            EmplaceNoAllocation(offset, std::forward<Args>(args)...);
+        }
 
-    Vector() = default;
+        ++size_;
 
-    Vector(Vector&& other) noexcept
-    {
-        *this = std::move(other);
+        return begin() + offset;
     }
 
-    explicit Vector(size_t size)
-        : data_(size)
-        , size_(size)
+    VECTOR_CONSTEXPR iterator Erase(const_iterator pos) noexcept(std::is_nothrow_move_assignable_v<T>)
     {
-        std::uninitialized_value_construct_n(data_.GetAddress(), size);
+        assert(pos >= cbegin() && pos < cend());
+        return Erase(pos, pos + 1);
     }
 
-    Vector(const Vector& other)
-        : data_(other.size_)
-        , size_(other.size_)  //
+    // Удаляет элементы [first, last), сдвигая хвост вектора один раз
+    VECTOR_CONSTEXPR iterator Erase(const_iterator first, const_iterator last) noexcept(std::is_nothrow_move_assignable_v<T>)
     {
-        std::uninitialized_copy_n(other.data_.GetAddress(), size_, data_.GetAddress());
-    }
+        assert(cbegin() <= first && first <= last && last <= cend());
+        const size_t offset = first - cbegin();
+        const size_t count = last - first;
+        if (count == 0)
+        {
+            // Иначе хвост был бы перемещён сам в себя
+            return begin() + offset;
+        }
+        T* gap = data_ + offset;
+        VECTOR_STATS_RECORD(VectorEvent::kErase, count);
 
-    using iterator = T*;
-    using const_iterator = const T*;
+        if (CanRelocate())
+        {
+            DestroyN(gap, count);
+            RelocateOverlapping(gap + count, size_ - offset - count, gap);
+        }
+        else
+        {
+            T* old_end = data_ + size_;
+            std::move(gap + count, old_end, gap);
+            DestroyN(old_end - count, count);
+        }
 
-    iterator begin() noexcept
-    {
-        return data_.GetAddress();
-    }
+        size_ -= count;
 
-    iterator end() noexcept
-    {
-        return iterator{ begin() + size_ };
+        return begin() + offset;
     }
 
-    const_iterator begin() const noexcept
+    // Удаляет за один проход все элементы, для которых pred возвращает true,
+    // сохраняя порядок остальных. Возвращает количество удалённых элементов
+    template <typename Predicate>
+    VECTOR_CONSTEXPR size_t EraseIf(Predicate pred)
     {
-        return data_.GetAddress();
+        const iterator new_end = std::remove_if(begin(), end(), pred);
+        const size_t count = end() - new_end;
+        Erase(new_end, end());
+        return count;
     }
 
-    const_iterator end() const noexcept
+    // Удаляет элемент за O(1), перемещая на его место последний элемент.
+    // Порядок элементов не сохраняется
+    VECTOR_CONSTEXPR iterator EraseUnordered(const_iterator pos) noexcept(std::is_nothrow_move_assignable_v<T>)
     {
-        return const_iterator{ begin() + size_ };
+        assert(pos >= cbegin() && pos < cend());
+        iterator it = begin() + (pos - cbegin());
+        if (it != end() - 1)
+        {
+            *it = std::move(*(end() - 1));
+        }
+        PopBack();
+        return it;
     }
 
-    const_iterator cbegin() const noexcept
+    VECTOR_CONSTEXPR iterator Insert(const_iterator pos, const T& value)
     {
-        return begin();
+        return Emplace(pos, value);
     }
 
-    const_iterator cend() const noexcept
+    VECTOR_CONSTEXPR iterator Insert(const_iterator pos, T&& value)
     {
-        return end();
+        return Emplace(pos, std::move(value));
     }
 
-    //###EMPLACE() DEPENDENCIES START#####
-    private:
-    
-    void EmplaceWithAllocationMove(RawMemory<T>& temp_container, size_t offset, const_iterator pos)
-    {
-        try
-        {
-            std::uninitialized_move_n(data_.GetAddress(), offset, temp_container.GetAddress());
-            std::uninitialized_move_n(data_.GetAddress() + offset, std::distance(pos, cend()), temp_container.GetAddress() + offset + 1);
-        }
-        catch (...)
-        {
-            std::destroy_at(temp_container.GetAddress() + offset);
-            temp_container.~RawMemory();
-        }
-    }
-    
-    void EmplaceWithAllocationCopy(RawMemory<T>& temp_container, size_t offset, const_iterator pos)
+    // Вставляет count копий value перед pos
+    VECTOR_CONSTEXPR iterator Insert(const_iterator pos, size_t count, const T& value)
     {
-        try
-        {
-            std::uninitialized_copy_n(data_.GetAddress(), offset, temp_container.GetAddress());
-            std::uninitialized_copy_n(data_.GetAddress() + offset, std::distance(pos, cend()), temp_container.GetAddress() + offset);
-        }
-        catch (...)
+        const size_t offset = pos - cbegin();
+        const auto insert_copies = [this, offset, count](const T& item) {
+            return InsertN(offset, count,
+                [this, &item](T* to, size_t, size_t n) { UninitializedFillN(to, n, item); },
+                [&item](T* to, size_t, size_t n) { std::fill_n(to, n, item); });
+        };
+
+        if (IsInsideElements(value))
         {
-            std::destroy_at(temp_container.GetAddress() + offset);
-            temp_container.~RawMemory();
+            // value ссылается на элемент вектора, который может быть сдвинут или перемещён при вставке
+            const T copy(value);
+            return insert_copies(copy);
         }
+
+        return insert_copies(value);
     }
-    
-    void EmplaceWithAllocation(RawMemory<T>& temp_container, size_t offset, const_iterator pos)
+
+    // Вставляет перед pos элементы диапазона [first, last), который не должен ссылаться на элементы вектора.
+    // Для однонаправленных итераторов память резервируется и хвост сдвигается один раз
+    template <typename InputIt, typename = std::enable_if_t<std::is_convertible_v<
+        typename std::iterator_traits<InputIt>::iterator_category, std::input_iterator_tag>>>
+    VECTOR_CONSTEXPR iterator Insert(const_iterator pos, InputIt first, InputIt last)
     {
-        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>)
+        const size_t offset = pos - cbegin();
+
+        using Category = typename std::iterator_traits<InputIt>::iterator_category;
+        if constexpr (std::is_convertible_v<Category, std::forward_iterator_tag>)
         {
-            EmplaceWithAllocationMove(temp_container, offset, pos);
+            const size_t count = static_cast<size_t>(std::distance(first, last));
+
+            return InsertN(offset, count,
+                [this, first](T* to, size_t from, size_t n) { UninitializedCopyN(std::next(first, from), n, to); },
+                [first](T* to, size_t from, size_t n) { std::copy_n(std::next(first, from), n, to); });
         }
         else
         {
-            EmplaceWithAllocationCopy(temp_container, offset, pos);
+            // Количество элементов заранее неизвестно: дописываем их в конец и переставляем на место
+            const size_t old_size = size_;
+            for (; first != last; ++first)
+            {
+                EmplaceBack(*first);
+            }
+            std::rotate(begin() + offset, begin() + old_size, end());
+            return begin() + offset;
         }
+    }
 
-        std::destroy_n(data_.GetAddress(), size_);
-
-        data_.Swap(temp_container);
+    VECTOR_CONSTEXPR iterator Insert(const_iterator pos, std::initializer_list<T> values)
+    {
+        return Insert(pos, values.begin(), values.end());
     }
-    
-    void EmplaceNoAllocation(T obj, size_t offset)
+
+    // Дописывает в конец вектора элементы диапазона [first, last)
+    template <typename InputIt, typename = std::enable_if_t<std::is_convertible_v<
+        typename std::iterator_traits<InputIt>::iterator_category, std::input_iterator_tag>>>
+    VECTOR_CONSTEXPR void Append(InputIt first, InputIt last)
     {
-        std::move_backward(begin() + offset, end(), begin() + size_ + 1);
-        new (data_ + offset) T(std::forward<T>(obj));
+        Insert(cend(), first, last);
     }
-    
-    public:
-    //###EMPLACE() DEPENDENCIES END#######
-    
-    template <typename... Args>
-    iterator Emplace(const_iterator pos, Args&&... args)
+
+    VECTOR_CONSTEXPR void Append(std::initializer_list<T> values)
     {
-        size_t offset = pos - cbegin();
+        Insert(cend(), values.begin(), values.end());
+    }
 
-        if (Capacity() <= size_)
+    // Применяет за один проход список правок (см. VectorEdit), упорядоченный по position так,
+    // что каждая правка начинается не раньше конца области, удаляемой предыдущей.
+    // Вставляемые значения не должны ссылаться на элементы вектора.
+    // Каждый сохраняемый элемент сдвигается не больше одного раза, поэтому k правок стоят O(n + k),
+    // а не O(k·n), как при последовательных Insert и Erase.
+    // Если ёмкости не хватает, результат собирается в новом буфере со строгой гарантией,
+    // иначе правки применяются на месте с базовой гарантией
+    template <typename EditRange>
+    VECTOR_CONSTEXPR void ApplyEdits(const EditRange& edits)
+    {
+        size_t erased = 0;
+        size_t inserted = 0;
+        [[maybe_unused]] size_t previous_end = 0;
+        for (const VectorEdit<T>& edit : edits)
         {
-            RawMemory<T> new_data(Capacity() == 0 ? 1 : (Capacity() * 2));
-            new (new_data + offset) T(std::forward<Args>(args)...);
-
-            EmplaceWithAllocation(new_data, offset, pos);
+            assert(edit.position >= previous_end && edit.erase_count <= size_ - edit.position);
+            previous_end = edit.position + edit.erase_count;
+            erased += edit.erase_count;
+            inserted += edit.insert_count;
         }
-        else
+        if (erased == 0 && inserted == 0)
         {
-            EmplaceNoAllocation(T(std::forward<Args>(args)...), offset);
+            return;
         }
+        VECTOR_STATS_RECORD(VectorEvent::kErase, erased);
 
-        ++size_;
-
-        return &data_[offset];
-    }
-
-    iterator Erase(const_iterator pos) noexcept(std::is_nothrow_move_assignable_v<T>)
-    {
-        if constexpr (std::is_nothrow_move_assignable_v<T>)
+        const size_t new_size = size_ - erased + inserted;
+        if constexpr (kCanGrowInPlace && std::is_nothrow_copy_constructible_v<T>)
         {
-            for (iterator iter = begin() + std::distance(cbegin(), pos); iter != end() - 1; ++iter)
+            // Копирование не выбрасывает исключений, поэтому правки на месте сохраняют строгую гарантию
+            if (!IsConstantEvaluated() && new_size > Capacity())
             {
-                *iter = std::move(*std::next(iter, 1));
+                InvalidateIterators();
+                data_.Reallocate(GrowCapacity(new_size), size_);
             }
-            std::destroy_at(begin() + size_ - 1);
+        }
+
+        if (new_size > Capacity())
+        {
+            ApplyEditsWithAllocation(edits, new_size);
         }
         else
         {
-            for (iterator iter = pos - begin(); iter != end() - 1; ++iter)
-            {
-                *iter = next(*iter, 1);
-            }
-            std::destroy_at(begin() + size_ - 1);
+            ApplyEditsInPlace(edits, new_size);
         }
-
-        size_--;
-
-        return &data_[pos - begin()];
     }
 
-    iterator Insert(const_iterator pos, const T& value)
+    VECTOR_CONSTEXPR void ApplyEdits(std::initializer_list<VectorEdit<T>> edits)
     {
-        return Emplace(pos, value);
+        ApplyEdits<std::initializer_list<VectorEdit<T>>>(edits);
     }
 
-    iterator Insert(const_iterator pos, T&& value)
+    VECTOR_CONSTEXPR void Resize(size_t new_size)
     {
-        return Emplace(pos, std::move(value));
+        if (new_size < size_)
+        {
+            DestroyN(data_.GetAddress() + new_size, size_ - new_size);
+
+        }
+        else
+        {
+            Reserve(new_size);
+            UninitializedValueConstructN(data_.GetAddress() + size_, new_size - size_);
+        }
+        size_ = new_size;
     }
 
-    void Resize(size_t new_size)
+    // То же, что Resize, но новые элементы тривиальных типов остаются незаполненными
+    VECTOR_CONSTEXPR void ResizeDefaultInit(size_t new_size)
     {
         if (new_size < size_)
         {
-            std::destroy_n(data_.GetAddress() + new_size, size_ - new_size);
-
+            DestroyN(data_.GetAddress() + new_size, size_ - new_size);
         }
         else
         {
             Reserve(new_size);
-            std::uninitialized_value_construct_n(data_.GetAddress() + size_, new_size - size_);
+            UninitializedDefaultConstructN(data_.GetAddress() + size_, new_size - size_);
         }
         size_ = new_size;
     }
 
-    void PushBack(const T& value)
+    // Увеличивает размер до max_size без заполнения новых элементов тривиальных типов и передаёт
+    // буфер в operation(data, max_size). operation записывает данные и возвращает итоговый размер
+    // (не больше max_size), элементы за которым разрушаются.
+    // Предназначен для заполнения вектора функциями вроде read() без предварительного обнуления
+    template <typename Operation>
+    VECTOR_CONSTEXPR void ResizeAndOverwrite(size_t max_size, Operation operation)
+    {
+        ResizeDefaultInit(std::max(max_size, size_));
+        const size_t new_size = operation(data_.GetAddress(), max_size);
+        assert(new_size <= max_size);
+        Resize(std::min(new_size, size_));
+    }
+
+    VECTOR_CONSTEXPR void PushBack(const T& value)
     {
         EmplaceBack(std::move(value));
     }
 
-    void PushBack(T&& value)
+    VECTOR_CONSTEXPR void PushBack(T&& value)
     {
         EmplaceBack(std::move(value));
     }
 
-    void PopBack() /* noexcept */
+    VECTOR_CONSTEXPR void PopBack() /* noexcept */
     {
         Erase(end() - 1);
     }
 
-    Vector& operator=(const Vector& rhs)
+    VECTOR_CONSTEXPR Vector& operator=(const Vector& rhs)
     {
         if (this != &rhs)
         {
+            if constexpr (AllocTraits::propagate_on_container_copy_assignment::value)
+            {
+                if (data_.GetAllocator() != rhs.data_.GetAllocator())
+                {
+                    // Память, выделенную старым аллокатором, нужно вернуть ему же
+                    DestroyN(data_.GetAddress(), size_);
+                    size_ = 0;
+                    RawMemory<T, Alloc> empty(rhs.data_.GetAllocator());
+                    InvalidateIterators();
+                    data_.Swap(empty);
+                }
+            }
+
             if (rhs.size_ > data_.Capacity())
             {
-                Vector tmp(rhs);
+                Vector tmp(rhs.size_, rhs, data_.GetAllocator());
                 Swap(tmp);
 
             }
@@ -303,14 +1766,14 @@ public:
             {
                 size_t new_size = rhs.Size();
 
-                std::copy_n(rhs.data_.GetAddress(), new_size <= size_ ? new_size : size_, data_.GetAddress());
+                CopyAssignN(rhs.data_.GetAddress(), new_size <= size_ ? new_size : size_, data_.GetAddress());
                 if (new_size <= size_)
                 {
-                    std::destroy_n(data_.GetAddress() + new_size, size_ - new_size);
+                    DestroyN(data_.GetAddress() + new_size, size_ - new_size);
                 }
                 else
                 {
-                    std::uninitialized_copy_n(rhs.data_.GetAddress() + size_, new_size - size_, data_.GetAddress() + size_);
+                    UninitializedCopyN(rhs.data_.GetAddress() + size_, new_size - size_, data_.GetAddress() + size_);
                 }
                 size_ = new_size;
             }
@@ -319,84 +1782,201 @@ public:
         return *this;
     }
 
-    Vector& operator=(Vector&& rhs) noexcept
+    VECTOR_CONSTEXPR Vector& operator=(Vector&& rhs) noexcept(AllocTraits::propagate_on_container_move_assignment::value
+                                             || AllocTraits::is_always_equal::value)
     {
         if (this != &rhs)
         {
-            data_.Swap(rhs.data_);
-            std::swap(size_, rhs.size_);
+            if constexpr (AllocTraits::propagate_on_container_move_assignment::value
+                          || AllocTraits::is_always_equal::value)
+            {
+                InvalidateIterators();
+                rhs.InvalidateIterators();
+                data_.Swap(rhs.data_);
+                std::swap(size_, rhs.size_);
+            }
+            else if (data_.GetAllocator() == rhs.data_.GetAllocator())
+            {
+                InvalidateIterators();
+                rhs.InvalidateIterators();
+                data_.Swap(rhs.data_);
+                std::swap(size_, rhs.size_);
+            }
+            else
+            {
+                // Буфер rhs нельзя забрать: его освобождает другой аллокатор.
+                // Остаётся переместить элементы поштучно в память своего аллокатора
+                Vector tmp(data_.GetAllocator());
+                tmp.Reserve(rhs.size_);
+                tmp.UninitializedMoveOrCopyN(rhs.data_.GetAddress(), rhs.size_, tmp.data_.GetAddress());
+                tmp.size_ = rhs.size_;
+                Swap(tmp);
+            }
         }
 
         return *this;
     }
 
-    void Swap(Vector& other) noexcept
+    // Если аллокатор не распространяется при обмене (propagate_on_container_swap),
+    // аллокаторы обоих векторов должны быть равны
+    VECTOR_CONSTEXPR void Swap(Vector& other) noexcept
     {
+        assert(AllocTraits::propagate_on_container_swap::value || AllocTraits::is_always_equal::value
+               || data_.GetAllocator() == other.data_.GetAllocator());
+        InvalidateIterators();
+        other.InvalidateIterators();
         other.data_.Swap(data_);
         std::swap(other.size_, size_);
     }
 
-    constexpr void MoveOrCopy(RawMemory<T>& new_data)
+    VECTOR_CONSTEXPR void MoveOrCopy(RawMemory<T, Alloc>& new_data)
     {
-        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>)
+        if (Capacity() != 0)
         {
-            std::uninitialized_move_n(data_.GetAddress(), size_, new_data.GetAddress());
+            VECTOR_STATS_RECORD(VectorEvent::kReallocate, size_);
         }
-        else
+        Ops::MoveOrCopyAll(data_.GetAllocator(), data_.GetAddress(), size_, new_data.GetAddress());
+
+        InvalidateIterators();
+        data_.Swap(new_data);
+    }
+
+    VECTOR_CONSTEXPR void Reserve(size_t new_capacity)
+    {
+        if (new_capacity <= data_.Capacity())
         {
-            std::uninitialized_copy_n(data_.GetAddress(), size_, new_data.GetAddress());
+            return;
         }
 
-        std::destroy_n(data_.GetAddress(), size_);
+        if (CanRelocate())
+        {
+            InvalidateIterators();
+            data_.Reallocate(new_capacity, size_);
+        }
+        else
+        {
+            RawMemory<T, Alloc> new_data(new_capacity, data_.GetAllocator());
 
-        data_.Swap(new_data);
+            MoveOrCopy(new_data);
+        }
+    }
+
+    // Разрушает все элементы, сохраняя ёмкость
+    VECTOR_CONSTEXPR void Clear() noexcept
+    {
+        DestroyN(data_.GetAddress(), size_);
+        size_ = 0;
     }
 
-    void Reserve(size_t new_capacity)
+    // Уменьшает ёмкость до размера вектора, перенося элементы в буфер подходящего размера.
+    // Пустой вектор освобождает буфер полностью
+    VECTOR_CONSTEXPR void ShrinkToFit()
     {
-        if (new_capacity <= data_.Capacity()) 
+        if (Capacity() == size_)
         {
             return;
         }
 
-        RawMemory<T> new_data(new_capacity);
+        RawMemory<T, Alloc> new_data(size_, data_.GetAllocator());
 
         MoveOrCopy(new_data);
     }
 
-    ~Vector()
+    // Вызывает ShrinkToFit, если ёмкость превышает размер больше чем в ratio раз.
+    // Позволяет вернуть память, оставшуюся после кратковременного всплеска, не трогая векторы,
+    // которые просто заполнены не до конца. Возвращает true, если буфер был уменьшен
+    VECTOR_CONSTEXPR bool ShrinkIfWasteful(double ratio = 2.0)
     {
-        std::destroy_n(data_.GetAddress(), size_);
+        assert(ratio >= 1.0);
+        if (static_cast<double>(Capacity()) <= static_cast<double>(size_) * ratio)
+        {
+            return false;
+        }
+
+        ShrinkToFit();
+        return true;
     }
 
-    size_t Size() const noexcept
+    // Разрушает элементы и отдаёт буфер вместе с аллокатором, которым он выделен.
+    // Вектор остаётся пустым и без буфера. Буфер можно передать другому вектору через AdoptStorage
+    VECTOR_CONSTEXPR RawMemory<T, Alloc> ReleaseStorage() noexcept
+    {
+        Clear();
+        InvalidateIterators();
+        RawMemory<T, Alloc> storage(data_.GetAllocator());
+        storage.Swap(data_);
+        return storage;
+    }
+
+    // Разрушает элементы, освобождает текущий буфер и забирает storage вместе с его аллокатором.
+    // Вектор остаётся пустым с ёмкостью storage.Capacity()
+    VECTOR_CONSTEXPR void AdoptStorage(RawMemory<T, Alloc>&& storage) noexcept
+    {
+        Clear();
+        InvalidateIterators();
+        data_ = std::move(storage);
+    }
+
+    VECTOR_CONSTEXPR ~Vector()
+    {
+        DestroyN(data_.GetAddress(), size_);
+    }
+
+    VECTOR_CONSTEXPR size_t Size() const noexcept
     {
         return size_;
     }
 
-    size_t Capacity() const noexcept
+    VECTOR_CONSTEXPR size_t Capacity() const noexcept
     {
         return data_.Capacity();
     }
 
-    const T& operator[](size_t index) const noexcept
+    VECTOR_CONSTEXPR const T& operator[](size_t index) const noexcept
     {
         return const_cast<Vector&>(*this)[index];
     }
 
-    T& operator[](size_t index) noexcept
+    VECTOR_CONSTEXPR T& operator[](size_t index) noexcept
     {
         assert(index < size_);
+        VECTOR_HARDENED_CHECK(index < size_, "index is out of range");
+        return data_[index];
+    }
+
+    // Доступ с проверкой индекса в любом режиме сборки
+    VECTOR_CONSTEXPR const T& At(size_t index) const
+    {
+        return const_cast<Vector&>(*this).At(index);
+    }
+
+    VECTOR_CONSTEXPR T& At(size_t index)
+    {
+        if (index >= size_)
+        {
+            throw std::out_of_range("Vector index is out of range");
+        }
         return data_[index];
     }
 
+    // Указатель на первый элемент. В отличие от begin(), всегда обычный указатель
+    VECTOR_CONSTEXPR T* Data() noexcept
+    {
+        return data_.GetAddress();
+    }
+
+    VECTOR_CONSTEXPR const T* Data() const noexcept
+    {
+        return data_.GetAddress();
+    }
+
 
     template <typename... Args>
-    T& EmplaceBack(Args&&... args)
+    VECTOR_CONSTEXPR T& EmplaceBack(Args&&... args)
     {
         if (Capacity() > size_)
         {
-            new (data_ + size_) T(std::forward<Args>(args)...);
+            ConstructAt(data_ + size_, std::forward<Args>(args)...);
             ++size_;
         }
         else
@@ -409,6 +1989,57 @@ public:
 
 private:
 
-    RawMemory<T> data_;
+#ifdef ADVANCED_VECTOR_HARDENED
+    friend iterator;
+    friend const_iterator;
+
+    VECTOR_CONSTEXPR size_t IteratorGeneration() const noexcept
+    {
+        return generation_;
+    }
+
+    VECTOR_CONSTEXPR iterator MakeIterator(T* ptr) noexcept
+    {
+        return iterator(ptr, this);
+    }
+
+    VECTOR_CONSTEXPR const_iterator MakeIterator(const T* ptr) const noexcept
+    {
+        return const_iterator(ptr, this);
+    }
+#endif
+
+    // Вызывается перед каждой сменой или реаллокацией буфера
+    VECTOR_CONSTEXPR void InvalidateIterators() noexcept
+    {
+#ifdef ADVANCED_VECTOR_HARDENED
+        ++generation_;
+#endif
+    }
+
+#ifndef ADVANCED_VECTOR_HARDENED
+    static VECTOR_CONSTEXPR iterator MakeIterator(T* ptr) noexcept
+    {
+        return ptr;
+    }
+
+    static VECTOR_CONSTEXPR const_iterator MakeIterator(const T* ptr) noexcept
+    {
+        return ptr;
+    }
+#endif
+
+    // Копия other в памяти ёмкостью capacity, выделенной аллокатором alloc
+    VECTOR_CONSTEXPR Vector(size_t capacity, const Vector& other, const Alloc& alloc)
+        : data_(capacity, alloc)
+        , size_(other.size_)
+    {
+        UninitializedCopyN(other.data_.GetAddress(), size_, data_.GetAddress());
+    }
+
+    RawMemory<T, Alloc> data_;
     size_t size_ = 0;
+#ifdef ADVANCED_VECTOR_HARDENED
+    size_t generation_ = 0;
+#endif
 };
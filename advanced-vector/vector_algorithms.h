@@ -0,0 +1,552 @@
+#pragma once
+#include "vector.h"
+
+#include <cstdint>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define VECTOR_ALGORITHMS_AVX2
+#include <immintrin.h>
+#define VECTOR_ALGORITHMS_TARGET_AVX2 __attribute__((target("avx2,popcnt,bmi")))
+#endif
+
+// Поиск, подсчёт, минимум, максимум, сумма и фильтрация элементов Vector<int32_t>, Vector<float>
+// и Vector<double>. Каждая операция реализована скалярно и на AVX2; реализация выбирается
+// один раз во время выполнения по возможностям процессора.
+//
+// Результаты обеих реализаций совпадают побитово. Для этого скалярные версии минимума, максимума
+// и суммы вещественных чисел обрабатывают элементы в том же порядке, что и векторные:
+// kSimdLanes<T> независимых накопителей, в накопитель j попадают элементы с индексами
+// j, j + kSimdLanes<T>, ... из полных блоков, затем накопители объединяются по порядку,
+// и к результату по одному добавляются оставшиеся элементы.
+//
+// Векторные версии читают память невыровненными загрузками, а для буферов AlignedVector
+// (выровненных по строке кэша) эти загрузки никогда не пересекают границу строки кэша
+
+enum class Compare {
+    kLess,
+    kLessEqual,
+    kGreater,
+    kGreaterEqual,
+    kEqual,
+    kNotEqual,
+};
+
+template <typename T>
+inline constexpr bool IsSimdElementV = std::is_same_v<T, int32_t> || std::is_same_v<T, float>
+    || std::is_same_v<T, double>;
+
+// Целые суммируются в 64 бита, переполнение происходит по модулю 2^64
+template <typename T>
+using SimdSumType = std::conditional_t<std::is_integral_v<T>, int64_t, T>;
+
+// Количество элементов T в 256-битном регистре
+template <typename T>
+inline constexpr size_t kSimdLanes = 32 / sizeof(T);
+
+template <typename T>
+constexpr bool CompareValues(T x, Compare cmp, T value) noexcept {
+    switch (cmp) {
+        case Compare::kLess:
+            return x < value;
+        case Compare::kLessEqual:
+            return x <= value;
+        case Compare::kGreater:
+            return x > value;
+        case Compare::kGreaterEqual:
+            return x >= value;
+        case Compare::kEqual:
+            return x == value;
+        case Compare::kNotEqual:
+            return x != value;
+    }
+    return false;
+}
+
+// Шаги минимума и максимума в том виде, в котором их выполняют MINPS/MAXPS:
+// при сравнении с NaN результатом становится накопленное значение m
+template <typename T>
+constexpr T MinStep(T x, T m) noexcept {
+    return x < m ? x : m;
+}
+
+template <typename T>
+constexpr T MaxStep(T x, T m) noexcept {
+    return x > m ? x : m;
+}
+
+template <typename T>
+struct ScalarKernels {
+    static constexpr size_t kLanes = kSimdLanes<T>;
+
+    // Возвращает индекс первого элемента, равного value, или n
+    static size_t Find(const T* data, size_t n, T value) noexcept {
+        for (size_t i = 0; i < n; ++i) {
+            if (data[i] == value) {
+                return i;
+            }
+        }
+        return n;
+    }
+
+    static size_t Count(const T* data, size_t n, T value) noexcept {
+        size_t count = 0;
+        for (size_t i = 0; i < n; ++i) {
+            count += data[i] == value;
+        }
+        return count;
+    }
+
+    static T Min(const T* data, size_t n) noexcept {
+        return Reduce(data, n, MinStep<T>);
+    }
+
+    static T Max(const T* data, size_t n) noexcept {
+        return Reduce(data, n, MaxStep<T>);
+    }
+
+    static SimdSumType<T> Sum(const T* data, size_t n) noexcept {
+        if constexpr (std::is_integral_v<T>) {
+            uint64_t sum = 0;
+            for (size_t i = 0; i < n; ++i) {
+                sum += static_cast<uint64_t>(static_cast<int64_t>(data[i]));
+            }
+            return static_cast<int64_t>(sum);
+        } else {
+            T lanes[kLanes] = {};
+            size_t i = 0;
+            for (; i + kLanes <= n; i += kLanes) {
+                for (size_t j = 0; j < kLanes; ++j) {
+                    lanes[j] += data[i + j];
+                }
+            }
+            return FinishSum(lanes, data + i, n - i);
+        }
+    }
+
+    // Оставляет в начале data (в исходном порядке) элементы x, для которых CompareValues(x, cmp, value)
+    // истинно, и возвращает их количество
+    static size_t Filter(T* data, size_t n, Compare cmp, T value) noexcept {
+        return FilterTail(data, 0, 0, n, cmp, value);
+    }
+
+    // Продолжает фильтрацию с элемента in, когда в начале data уже собрано out элементов
+    static size_t FilterTail(T* data, size_t out, size_t in, size_t n, Compare cmp, T value) noexcept {
+        for (; in < n; ++in) {
+            if (CompareValues(data[in], cmp, value)) {
+                data[out++] = data[in];
+            }
+        }
+        return out;
+    }
+
+    // Объединяет накопители по порядку и добавляет к ним оставшиеся tail_size элементов
+    static T FinishSum(const T* lanes, const T* tail, size_t tail_size) noexcept {
+        T sum = lanes[0];
+        for (size_t j = 1; j < kLanes; ++j) {
+            sum += lanes[j];
+        }
+        for (size_t i = 0; i < tail_size; ++i) {
+            sum += tail[i];
+        }
+        return sum;
+    }
+
+    template <typename Step>
+    static T FinishReduce(const T* lanes, const T* tail, size_t tail_size, Step step) noexcept {
+        T result = lanes[0];
+        for (size_t j = 1; j < kLanes; ++j) {
+            result = step(lanes[j], result);
+        }
+        for (size_t i = 0; i < tail_size; ++i) {
+            result = step(tail[i], result);
+        }
+        return result;
+    }
+
+private:
+    template <typename Step>
+    static T Reduce(const T* data, size_t n, Step step) noexcept {
+        assert(n > 0);
+        if (n < kLanes) {
+            T result = data[0];
+            for (size_t i = 1; i < n; ++i) {
+                result = step(data[i], result);
+            }
+            return result;
+        }
+
+        T lanes[kLanes];
+        std::copy_n(data, kLanes, lanes);
+        size_t i = kLanes;
+        for (; i + kLanes <= n; i += kLanes) {
+            for (size_t j = 0; j < kLanes; ++j) {
+                lanes[j] = step(data[i + j], lanes[j]);
+            }
+        }
+        return FinishReduce(lanes, data + i, n - i, step);
+    }
+};
+
+#ifdef VECTOR_ALGORITHMS_AVX2
+
+// Таблица перестановок для упаковки выбранных элементов регистра в его начало:
+// строка mask содержит индексы 32-битных слов, которые нужно собрать подряд
+struct CompactTable {
+    alignas(32) uint32_t indices[256][8];
+};
+
+// Lanes - количество элементов в регистре, каждый занимает 8 / Lanes 32-битных слов
+template <size_t Lanes>
+constexpr CompactTable MakeCompactTable() {
+    constexpr size_t kWords = 8 / Lanes;
+    CompactTable table{};
+    for (size_t mask = 0; mask < (size_t{1} << Lanes); ++mask) {
+        size_t out = 0;
+        for (size_t lane = 0; lane < Lanes; ++lane) {
+            if (mask >> lane & 1) {
+                for (size_t word = 0; word < kWords; ++word) {
+                    table.indices[mask][out++] = static_cast<uint32_t>(lane * kWords + word);
+                }
+            }
+        }
+    }
+    return table;
+}
+
+inline constexpr CompactTable kCompact32 = MakeCompactTable<8>();
+inline constexpr CompactTable kCompact64 = MakeCompactTable<4>();
+
+// Операции над 256-битными регистрами для каждого из поддерживаемых типов
+template <typename T>
+struct Avx2Ops;
+
+template <>
+struct Avx2Ops<float> {
+    using Reg = __m256;
+
+    VECTOR_ALGORITHMS_TARGET_AVX2 static Reg Load(const float* p) noexcept {
+        return _mm256_loadu_ps(p);
+    }
+    VECTOR_ALGORITHMS_TARGET_AVX2 static void Store(float* p, Reg x) noexcept {
+        _mm256_storeu_ps(p, x);
+    }
+    VECTOR_ALGORITHMS_TARGET_AVX2 static Reg Broadcast(float value) noexcept {
+        return _mm256_set1_ps(value);
+    }
+    VECTOR_ALGORITHMS_TARGET_AVX2 static Reg Min(Reg x, Reg m) noexcept {
+        return _mm256_min_ps(x, m);
+    }
+    VECTOR_ALGORITHMS_TARGET_AVX2 static Reg Max(Reg x, Reg m) noexcept {
+        return _mm256_max_ps(x, m);
+    }
+    VECTOR_ALGORITHMS_TARGET_AVX2 static Reg Add(Reg a, Reg b) noexcept {
+        return _mm256_add_ps(a, b);
+    }
+    VECTOR_ALGORITHMS_TARGET_AVX2 static Reg Zero() noexcept {
+        return _mm256_setzero_ps();
+    }
+
+    // Порядковые сравнения ложны для NaN, а != для NaN истинно, как и в скалярном коде
+    template <Compare Cmp>
+    VECTOR_ALGORITHMS_TARGET_AVX2 static unsigned Mask(Reg x, Reg value) noexcept {
+        constexpr int kPredicate = Cmp == Compare::kLess ? _CMP_LT_OQ
+            : Cmp == Compare::kLessEqual  ? _CMP_LE_OQ
+            : Cmp == Compare::kGreater    ? _CMP_GT_OQ
+            : Cmp == Compare::kGreaterEqual ? _CMP_GE_OQ
+            : Cmp == Compare::kEqual      ? _CMP_EQ_OQ
+                                          : _CMP_NEQ_UQ;
+        return static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(x, value, kPredicate)));
+    }
+
+    VECTOR_ALGORITHMS_TARGET_AVX2 static Reg Compact(Reg x, unsigned mask) noexcept {
+        const __m256i indices = _mm256_load_si256(reinterpret_cast<const __m256i*>(kCompact32.indices[mask]));
+        return _mm256_permutevar8x32_ps(x, indices);
+    }
+};
+
+template <>
+struct Avx2Ops<double> {
+    using Reg = __m256d;
+
+    VECTOR_ALGORITHMS_TARGET_AVX2 static Reg Load(const double* p) noexcept {
+        return _mm256_loadu_pd(p);
+    }
+    VECTOR_ALGORITHMS_TARGET_AVX2 static void Store(double* p, Reg x) noexcept {
+        _mm256_storeu_pd(p, x);
+    }
+    VECTOR_ALGORITHMS_TARGET_AVX2 static Reg Broadcast(double value) noexcept {
+        return _mm256_set1_pd(value);
+    }
+    VECTOR_ALGORITHMS_TARGET_AVX2 static Reg Min(Reg x, Reg m) noexcept {
+        return _mm256_min_pd(x, m);
+    }
+    VECTOR_ALGORITHMS_TARGET_AVX2 static Reg Max(Reg x, Reg m) noexcept {
+        return _mm256_max_pd(x, m);
+    }
+    VECTOR_ALGORITHMS_TARGET_AVX2 static Reg Add(Reg a, Reg b) noexcept {
+        return _mm256_add_pd(a, b);
+    }
+    VECTOR_ALGORITHMS_TARGET_AVX2 static Reg Zero() noexcept {
+        return _mm256_setzero_pd();
+    }
+
+    template <Compare Cmp>
+    VECTOR_ALGORITHMS_TARGET_AVX2 static unsigned Mask(Reg x, Reg value) noexcept {
+        constexpr int kPredicate = Cmp == Compare::kLess ? _CMP_LT_OQ
+            : Cmp == Compare::kLessEqual  ? _CMP_LE_OQ
+            : Cmp == Compare::kGreater    ? _CMP_GT_OQ
+            : Cmp == Compare::kGreaterEqual ? _CMP_GE_OQ
+            : Cmp == Compare::kEqual      ? _CMP_EQ_OQ
+                                          : _CMP_NEQ_UQ;
+        return static_cast<unsigned>(_mm256_movemask_pd(_mm256_cmp_pd(x, value, kPredicate)));
+    }
+
+    VECTOR_ALGORITHMS_TARGET_AVX2 static Reg Compact(Reg x, unsigned mask) noexcept {
+        const __m256i indices = _mm256_load_si256(reinterpret_cast<const __m256i*>(kCompact64.indices[mask]));
+        return _mm256_castps_pd(_mm256_permutevar8x32_ps(_mm256_castpd_ps(x), indices));
+    }
+};
+
+template <>
+struct Avx2Ops<int32_t> {
+    using Reg = __m256i;
+
+    VECTOR_ALGORITHMS_TARGET_AVX2 static Reg Load(const int32_t* p) noexcept {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    }
+    VECTOR_ALGORITHMS_TARGET_AVX2 static void Store(int32_t* p, Reg x) noexcept {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), x);
+    }
+    VECTOR_ALGORITHMS_TARGET_AVX2 static Reg Broadcast(int32_t value) noexcept {
+        return _mm256_set1_epi32(value);
+    }
+    VECTOR_ALGORITHMS_TARGET_AVX2 static Reg Min(Reg x, Reg m) noexcept {
+        return _mm256_min_epi32(x, m);
+    }
+    VECTOR_ALGORITHMS_TARGET_AVX2 static Reg Max(Reg x, Reg m) noexcept {
+        return _mm256_max_epi32(x, m);
+    }
+
+    // В AVX2 есть только сравнения на равенство и "больше", остальные получаются
+    // перестановкой аргументов и отрицанием маски
+    template <Compare Cmp>
+    VECTOR_ALGORITHMS_TARGET_AVX2 static unsigned Mask(Reg x, Reg value) noexcept {
+        if constexpr (Cmp == Compare::kLess) {
+            return MoveMask(_mm256_cmpgt_epi32(value, x));
+        } else if constexpr (Cmp == Compare::kLessEqual) {
+            return MoveMask(_mm256_cmpgt_epi32(x, value)) ^ 0xFF;
+        } else if constexpr (Cmp == Compare::kGreater) {
+            return MoveMask(_mm256_cmpgt_epi32(x, value));
+        } else if constexpr (Cmp == Compare::kGreaterEqual) {
+            return MoveMask(_mm256_cmpgt_epi32(value, x)) ^ 0xFF;
+        } else if constexpr (Cmp == Compare::kEqual) {
+            return MoveMask(_mm256_cmpeq_epi32(x, value));
+        } else {
+            return MoveMask(_mm256_cmpeq_epi32(x, value)) ^ 0xFF;
+        }
+    }
+
+    VECTOR_ALGORITHMS_TARGET_AVX2 static Reg Compact(Reg x, unsigned mask) noexcept {
+        const __m256i indices = _mm256_load_si256(reinterpret_cast<const __m256i*>(kCompact32.indices[mask]));
+        return _mm256_permutevar8x32_epi32(x, indices);
+    }
+
+private:
+    VECTOR_ALGORITHMS_TARGET_AVX2 static unsigned MoveMask(Reg cmp) noexcept {
+        return static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(cmp)));
+    }
+};
+
+template <typename T>
+struct Avx2Kernels {
+    using Ops = Avx2Ops<T>;
+    using Scalar = ScalarKernels<T>;
+    static constexpr size_t kLanes = kSimdLanes<T>;
+
+    VECTOR_ALGORITHMS_TARGET_AVX2 static size_t Find(const T* data, size_t n, T value) noexcept {
+        const auto v = Ops::Broadcast(value);
+        size_t i = 0;
+        for (; i + kLanes <= n; i += kLanes) {
+            if (const unsigned mask = Ops::template Mask<Compare::kEqual>(Ops::Load(data + i), v)) {
+                return i + static_cast<size_t>(__builtin_ctz(mask));
+            }
+        }
+        return i + Scalar::Find(data + i, n - i, value);
+    }
+
+    VECTOR_ALGORITHMS_TARGET_AVX2 static size_t Count(const T* data, size_t n, T value) noexcept {
+        const auto v = Ops::Broadcast(value);
+        size_t count = 0;
+        size_t i = 0;
+        for (; i + kLanes <= n; i += kLanes) {
+            count += static_cast<size_t>(__builtin_popcount(Ops::template Mask<Compare::kEqual>(Ops::Load(data + i), v)));
+        }
+        return count + Scalar::Count(data + i, n - i, value);
+    }
+
+    VECTOR_ALGORITHMS_TARGET_AVX2 static T Min(const T* data, size_t n) noexcept {
+        return Reduce<true>(data, n);
+    }
+
+    VECTOR_ALGORITHMS_TARGET_AVX2 static T Max(const T* data, size_t n) noexcept {
+        return Reduce<false>(data, n);
+    }
+
+    VECTOR_ALGORITHMS_TARGET_AVX2 static SimdSumType<T> Sum(const T* data, size_t n) noexcept {
+        size_t i = 0;
+        if constexpr (std::is_integral_v<T>) {
+            // Каждая половина регистра расширяется до четырёх 64-битных слагаемых
+            __m256i low = _mm256_setzero_si256();
+            __m256i high = _mm256_setzero_si256();
+            for (; i + kLanes <= n; i += kLanes) {
+                const __m256i x = Ops::Load(data + i);
+                low = _mm256_add_epi64(low, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(x)));
+                high = _mm256_add_epi64(high, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(x, 1)));
+            }
+            alignas(32) uint64_t lanes[4];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), _mm256_add_epi64(low, high));
+            const uint64_t sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+            return static_cast<int64_t>(sum + static_cast<uint64_t>(Scalar::Sum(data + i, n - i)));
+        } else {
+            auto acc = Ops::Zero();
+            for (; i + kLanes <= n; i += kLanes) {
+                acc = Ops::Add(acc, Ops::Load(data + i));
+            }
+            alignas(32) T lanes[kLanes];
+            Ops::Store(lanes, acc);
+            return Scalar::FinishSum(lanes, data + i, n - i);
+        }
+    }
+
+    VECTOR_ALGORITHMS_TARGET_AVX2 static size_t Filter(T* data, size_t n, Compare cmp, T value) noexcept {
+        switch (cmp) {
+            case Compare::kLess:
+                return FilterImpl<Compare::kLess>(data, n, value);
+            case Compare::kLessEqual:
+                return FilterImpl<Compare::kLessEqual>(data, n, value);
+            case Compare::kGreater:
+                return FilterImpl<Compare::kGreater>(data, n, value);
+            case Compare::kGreaterEqual:
+                return FilterImpl<Compare::kGreaterEqual>(data, n, value);
+            case Compare::kEqual:
+                return FilterImpl<Compare::kEqual>(data, n, value);
+            case Compare::kNotEqual:
+                return FilterImpl<Compare::kNotEqual>(data, n, value);
+        }
+        return 0;
+    }
+
+private:
+    template <bool IsMin>
+    VECTOR_ALGORITHMS_TARGET_AVX2 static T Reduce(const T* data, size_t n) noexcept {
+        if (n < kLanes) {
+            return IsMin ? Scalar::Min(data, n) : Scalar::Max(data, n);
+        }
+        auto acc = Ops::Load(data);
+        size_t i = kLanes;
+        for (; i + kLanes <= n; i += kLanes) {
+            acc = IsMin ? Ops::Min(Ops::Load(data + i), acc) : Ops::Max(Ops::Load(data + i), acc);
+        }
+        alignas(32) T lanes[kLanes];
+        Ops::Store(lanes, acc);
+        return Scalar::FinishReduce(lanes, data + i, n - i, IsMin ? MinStep<T> : MaxStep<T>);
+    }
+
+    // Каждый блок упаковывается перестановкой и записывается целиком. Запись не выходит
+    // за пределы текущего блока, потому что out никогда не обгоняет i
+    template <Compare Cmp>
+    VECTOR_ALGORITHMS_TARGET_AVX2 static size_t FilterImpl(T* data, size_t n, T value) noexcept {
+        const auto v = Ops::Broadcast(value);
+        size_t out = 0;
+        size_t i = 0;
+        for (; i + kLanes <= n; i += kLanes) {
+            const auto x = Ops::Load(data + i);
+            const unsigned mask = Ops::template Mask<Cmp>(x, v);
+            Ops::Store(data + out, Ops::Compact(x, mask));
+            out += static_cast<size_t>(__builtin_popcount(mask));
+        }
+        return Scalar::FilterTail(data, out, i, n, Cmp, value);
+    }
+};
+
+inline bool HasAvx2() noexcept {
+    static const bool has_avx2 = [] {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") != 0;
+    }();
+    return has_avx2;
+}
+
+#endif  // VECTOR_ALGORITHMS_AVX2
+
+// Набор реализаций, выбранный для типа T
+template <typename T>
+struct SimdKernels {
+    size_t (*find)(const T* data, size_t n, T value) noexcept;
+    size_t (*count)(const T* data, size_t n, T value) noexcept;
+    T (*min)(const T* data, size_t n) noexcept;
+    T (*max)(const T* data, size_t n) noexcept;
+    SimdSumType<T> (*sum)(const T* data, size_t n) noexcept;
+    size_t (*filter)(T* data, size_t n, Compare cmp, T value) noexcept;
+
+    template <typename Kernels>
+    static constexpr SimdKernels Make() noexcept {
+        return {Kernels::Find, Kernels::Count, Kernels::Min, Kernels::Max, Kernels::Sum, Kernels::Filter};
+    }
+};
+
+template <typename T>
+const SimdKernels<T>& GetSimdKernels() noexcept {
+    static_assert(IsSimdElementV<T>, "Only int32_t, float and double are supported");
+    static const SimdKernels<T> kernels = [] {
+#ifdef VECTOR_ALGORITHMS_AVX2
+        if (HasAvx2()) {
+            return SimdKernels<T>::template Make<Avx2Kernels<T>>();
+        }
+#endif
+        return SimdKernels<T>::template Make<ScalarKernels<T>>();
+    }();
+    return kernels;
+}
+
+// Второй параметр функций ниже не участвует в выводе T, поэтому FindValue(Vector<float>{}, 1) допустимо
+template <typename T>
+using SimdValue = std::enable_if_t<IsSimdElementV<T>, T>;
+
+// Возвращает индекс первого элемента, равного value, или v.Size(), если такого нет
+template <typename T, typename Alloc, typename Growth>
+size_t FindValue(const Vector<T, Alloc, Growth>& v, SimdValue<T> value) noexcept {
+    return GetSimdKernels<T>().find(v.Data(), v.Size(), value);
+}
+
+template <typename T, typename Alloc, typename Growth>
+size_t CountValue(const Vector<T, Alloc, Growth>& v, SimdValue<T> value) noexcept {
+    return GetSimdKernels<T>().count(v.Data(), v.Size(), value);
+}
+
+// Вектор не должен быть пустым
+template <typename T, typename Alloc, typename Growth>
+SimdValue<T> MinValue(const Vector<T, Alloc, Growth>& v) noexcept {
+    assert(v.Size() > 0);
+    return GetSimdKernels<T>().min(v.Data(), v.Size());
+}
+
+template <typename T, typename Alloc, typename Growth>
+SimdValue<T> MaxValue(const Vector<T, Alloc, Growth>& v) noexcept {
+    assert(v.Size() > 0);
+    return GetSimdKernels<T>().max(v.Data(), v.Size());
+}
+
+template <typename T, typename Alloc, typename Growth>
+SimdSumType<SimdValue<T>> SumValues(const Vector<T, Alloc, Growth>& v) noexcept {
+    return GetSimdKernels<T>().sum(v.Data(), v.Size());
+}
+
+// Оставляет в векторе, сохраняя порядок, только элементы x, для которых истинно сравнение "x cmp value".
+// Возвращает количество удалённых элементов
+template <typename T, typename Alloc, typename Growth>
+size_t KeepIf(Vector<T, Alloc, Growth>& v, Compare cmp, SimdValue<T> value) {
+    const size_t old_size = v.Size();
+    v.Resize(GetSimdKernels<T>().filter(v.Data(), old_size, cmp, value));
+    return old_size - v.Size();
+}
@@ -0,0 +1,333 @@
+#pragma once
+#include "vector.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Двоичная запись и чтение Vector в поток или файловый дескриптор.
+//
+// Данные начинаются с заголовка VectorFileHeader. Элементы тривиально копируемых типов
+// записываются одним блоком прямо из буфера вектора и читаются так же, поэтому файл можно
+// прочитать только на машине с тем же порядком байт и тем же sizeof(T).
+// Элементы остальных типов кодируются пользовательским кодеком и записываются блоками
+// примерно по kVectorIoChunkBytes байт. Кодек - объект с методами
+//     void Encode(const T& value, Vector<char>& out) const;        // дописывает байты value в out
+//     T Decode(const char*& data, const char* end) const;          // читает значение, сдвигая data
+// Decode должен выбросить исключение, если байты повреждены.
+//
+// ReadFrom сначала читает данные во временный вектор, поэтому при ошибке вектор-приёмник не меняется.
+// Если источник знает, сколько байт в нём осталось (обычный файл или поток с позиционированием),
+// и элементы из заголовка в них помещаются, память выделяется один раз под все элементы.
+// Иначе количество элементов не проверить до чтения данных, поэтому память выделяется
+// не больше kVectorIoMaxUpfrontBytes сверх уже прочитанного, а повреждённый заголовок приводит
+// к ошибке конца данных, а не к попытке выделить терабайты.
+// Ошибки ввода-вывода приводят к std::system_error для дескрипторов и std::ios_base::failure для
+// потоков, а данные неверного формата - к std::runtime_error
+
+struct VectorFileHeader {
+    static constexpr uint64_t kMagic = 0x5245534345564441;  // "ADVECSER"
+    static constexpr uint32_t kVersion = 1;
+    static constexpr uint32_t kByteOrderMark = 0x01020304;
+    static constexpr uint32_t kEncoded = 1;  // элементы записаны кодеком блоками
+
+    uint64_t magic = kMagic;
+    uint32_t version = kVersion;
+    uint32_t element_size = 0;  // sizeof(T) для побайтовой записи, 0 для записи кодеком
+    uint32_t byte_order = kByteOrderMark;
+    uint32_t flags = 0;
+    uint64_t size = 0;
+};
+
+// Размер блока, до которого кодек накапливает байты перед записью
+inline constexpr size_t kVectorIoChunkBytes = 64 * 1024;
+
+// Блок превышает kVectorIoChunkBytes не больше чем на один элемент. Блоки длиннее этого предела
+// не записываются, а при чтении считаются повреждёнными
+inline constexpr size_t kVectorIoMaxChunkBytes = 1024 * kVectorIoChunkBytes;
+
+// Сколько памяти чтение выделяет заранее, ещё не получив данных, если размер источника неизвестен
+inline constexpr size_t kVectorIoMaxUpfrontBytes = 256 * kVectorIoChunkBytes;
+
+class VectorOstreamSink {
+public:
+    explicit VectorOstreamSink(std::ostream& out) noexcept
+        : out_(out) {
+    }
+
+    void Write(const void* data, size_t size) {
+        out_.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        if (!out_) {
+            throw std::ios_base::failure("Vector: write failed");
+        }
+    }
+
+private:
+    std::ostream& out_;
+};
+
+class VectorIstreamSource {
+public:
+    explicit VectorIstreamSource(std::istream& in) noexcept
+        : in_(in) {
+    }
+
+    void Read(void* data, size_t size) {
+        in_.read(static_cast<char*>(data), static_cast<std::streamsize>(size));
+        if (static_cast<size_t>(in_.gcount()) != size) {
+            throw std::ios_base::failure("Vector: unexpected end of stream");
+        }
+    }
+
+    // Количество байт до конца потока или nullopt, если поток не поддерживает позиционирование.
+    // Позиция меняется через буфер потока, поэтому состояние потока не затрагивается
+    std::optional<uint64_t> Remaining() const {
+        std::streambuf* buffer = in_.rdbuf();
+        if (buffer == nullptr) {
+            return std::nullopt;
+        }
+        const std::streampos position = buffer->pubseekoff(0, std::ios_base::cur, std::ios_base::in);
+        if (position == std::streampos(-1)) {
+            return std::nullopt;
+        }
+        const std::streampos end = buffer->pubseekoff(0, std::ios_base::end, std::ios_base::in);
+        buffer->pubseekpos(position, std::ios_base::in);
+        if (end == std::streampos(-1) || end < position) {
+            return std::nullopt;
+        }
+        return static_cast<uint64_t>(end - position);
+    }
+
+private:
+    std::istream& in_;
+};
+
+// write() и read() могут передать только часть данных или прерваться сигналом,
+// поэтому вызываются в цикле
+class VectorFdSink {
+public:
+    explicit VectorFdSink(int fd) noexcept
+        : fd_(fd) {
+    }
+
+    void Write(const void* data, size_t size) {
+        const char* p = static_cast<const char*>(data);
+        while (size > 0) {
+            const ssize_t written = write(fd_, p, size);
+            if (written < 0) {
+                const int error = errno;
+                if (error == EINTR) {
+                    continue;
+                }
+                throw std::system_error(error, std::generic_category(), "Vector: write failed");
+            }
+            p += written;
+            size -= static_cast<size_t>(written);
+        }
+    }
+
+private:
+    int fd_;
+};
+
+class VectorFdSource {
+public:
+    explicit VectorFdSource(int fd) noexcept
+        : fd_(fd) {
+    }
+
+    void Read(void* data, size_t size) {
+        char* p = static_cast<char*>(data);
+        while (size > 0) {
+            const ssize_t received = read(fd_, p, size);
+            if (received < 0) {
+                const int error = errno;
+                if (error == EINTR) {
+                    continue;
+                }
+                throw std::system_error(error, std::generic_category(), "Vector: read failed");
+            }
+            if (received == 0) {
+                throw std::runtime_error("Vector: unexpected end of file");
+            }
+            p += received;
+            size -= static_cast<size_t>(received);
+        }
+    }
+
+    // Количество байт до конца обычного файла или nullopt для каналов, сокетов и устройств
+    std::optional<uint64_t> Remaining() const {
+        struct stat info;
+        if (fstat(fd_, &info) != 0 || !S_ISREG(info.st_mode)) {
+            return std::nullopt;
+        }
+        const off_t position = lseek(fd_, 0, SEEK_CUR);
+        if (position < 0 || position > info.st_size) {
+            return std::nullopt;
+        }
+        return static_cast<uint64_t>(info.st_size - position);
+    }
+
+private:
+    int fd_;
+};
+
+template <typename Sink, typename T, typename Alloc, typename Growth>
+void WriteVector(Sink& sink, const Vector<T, Alloc, Growth>& v) {
+    static_assert(std::is_trivially_copyable_v<T>, "Elements of this type need a codec");
+    VectorFileHeader header;
+    header.element_size = sizeof(T);
+    header.size = v.Size();
+    sink.Write(&header, sizeof(header));
+    if (v.Size() != 0) {
+        sink.Write(v.Data(), v.Size() * sizeof(T));
+    }
+}
+
+// Блок: количество элементов и количество байт, за которыми следуют сами байты
+template <typename Sink, typename T, typename Alloc, typename Growth, typename Codec>
+void WriteVector(Sink& sink, const Vector<T, Alloc, Growth>& v, const Codec& codec) {
+    VectorFileHeader header;
+    header.flags = VectorFileHeader::kEncoded;
+    header.size = v.Size();
+    sink.Write(&header, sizeof(header));
+
+    Vector<char> buffer;
+    buffer.Reserve(kVectorIoChunkBytes);
+    const auto flush = [&](uint64_t count) {
+        if (buffer.Size() > kVectorIoMaxChunkBytes) {
+            throw std::length_error("Vector: encoded element is too large");
+        }
+        const uint64_t chunk[2] = {count, buffer.Size()};
+        sink.Write(chunk, sizeof(chunk));
+        sink.Write(buffer.Data(), buffer.Size());
+        buffer.Clear();
+    };
+
+    uint64_t count = 0;
+    for (const T& value : v) {
+        codec.Encode(value, buffer);
+        ++count;
+        if (buffer.Size() >= kVectorIoChunkBytes) {
+            flush(count);
+            count = 0;
+        }
+    }
+    if (count != 0) {
+        flush(count);
+    }
+}
+
+// Читает и проверяет заголовок, возвращая количество элементов
+template <typename T, typename Source>
+size_t ReadVectorHeader(Source& source, bool encoded) {
+    VectorFileHeader header;
+    source.Read(&header, sizeof(header));
+    if (header.magic != VectorFileHeader::kMagic || header.version != VectorFileHeader::kVersion) {
+        throw std::runtime_error("Vector: data is not a serialized vector");
+    }
+    if (header.byte_order != VectorFileHeader::kByteOrderMark) {
+        throw std::runtime_error("Vector: data was written with a different byte order");
+    }
+    if (encoded != ((header.flags & VectorFileHeader::kEncoded) != 0)
+        || header.element_size != (encoded ? 0 : sizeof(T))) {
+        throw std::runtime_error("Vector: data holds elements of a different type");
+    }
+    if (header.size > static_cast<size_t>(-1) / sizeof(T)) {
+        throw std::runtime_error("Vector: serialized size is too large");
+    }
+    return static_cast<size_t>(header.size);
+}
+
+// Количество элементов, память под которые можно выделить, прочитав уже read элементов
+template <typename T>
+size_t VectorIoReadAhead(size_t read) noexcept {
+    return std::max({kVectorIoMaxUpfrontBytes / sizeof(T), read, size_t{1}});
+}
+
+// Элементы не заполняются нулями до чтения. Вектор, который помещается в оставшиеся байты
+// источника, и небольшой вектор читаются за одно выделение памяти. Большой вектор из источника
+// неизвестной длины читается частями, каждая из которых не больше уже прочитанного
+template <typename Source, typename T, typename Alloc, typename Growth>
+void ReadVector(Source& source, Vector<T, Alloc, Growth>& v) {
+    static_assert(std::is_trivially_copyable_v<T>, "Elements of this type need a codec");
+    const size_t size = ReadVectorHeader<T>(source, false);
+    Vector<T, Alloc, Growth> tmp(v.GetAllocator());
+    const std::optional<uint64_t> remaining = source.Remaining();
+    if (remaining && *remaining / sizeof(T) >= size) {
+        tmp.ResizeDefaultInit(size);
+        source.Read(tmp.Data(), size * sizeof(T));
+    }
+    while (tmp.Size() < size) {
+        const size_t read = tmp.Size();
+        const size_t count = std::min(size - read, VectorIoReadAhead<T>(read));
+        tmp.ResizeDefaultInit(read + count);
+        source.Read(tmp.Data() + read, count * sizeof(T));
+    }
+    v.Swap(tmp);
+}
+
+template <typename Source, typename T, typename Alloc, typename Growth, typename Codec>
+void ReadVector(Source& source, Vector<T, Alloc, Growth>& v, const Codec& codec) {
+    const size_t size = ReadVectorHeader<T>(source, true);
+    Vector<T, Alloc, Growth> tmp(v.GetAllocator());
+    tmp.Reserve(std::min(size, VectorIoReadAhead<T>(0)));
+
+    Vector<char> buffer;
+    while (tmp.Size() < size) {
+        uint64_t chunk[2];
+        source.Read(chunk, sizeof(chunk));
+        if (chunk[0] == 0 || chunk[0] > size - tmp.Size() || chunk[1] > kVectorIoMaxChunkBytes) {
+            throw std::runtime_error("Vector: corrupted chunk header");
+        }
+        buffer.ResizeDefaultInit(static_cast<size_t>(chunk[1]));
+        source.Read(buffer.Data(), buffer.Size());
+
+        const char* data = buffer.Data();
+        const char* end = data + buffer.Size();
+        for (uint64_t i = 0; i < chunk[0]; ++i) {
+            tmp.EmplaceBack(codec.Decode(data, end));
+        }
+        if (data != end) {
+            throw std::runtime_error("Vector: chunk has trailing bytes");
+        }
+    }
+    v.Swap(tmp);
+}
+
+template <typename T, typename Alloc, typename Growth, typename... Codec>
+void WriteTo(std::ostream& out, const Vector<T, Alloc, Growth>& v, const Codec&... codec) {
+    static_assert(sizeof...(Codec) <= 1);
+    VectorOstreamSink sink(out);
+    WriteVector(sink, v, codec...);
+}
+
+template <typename T, typename Alloc, typename Growth, typename... Codec>
+void WriteTo(int fd, const Vector<T, Alloc, Growth>& v, const Codec&... codec) {
+    static_assert(sizeof...(Codec) <= 1);
+    VectorFdSink sink(fd);
+    WriteVector(sink, v, codec...);
+}
+
+template <typename T, typename Alloc, typename Growth, typename... Codec>
+void ReadFrom(std::istream& in, Vector<T, Alloc, Growth>& v, const Codec&... codec) {
+    static_assert(sizeof...(Codec) <= 1);
+    VectorIstreamSource source(in);
+    ReadVector(source, v, codec...);
+}
+
+template <typename T, typename Alloc, typename Growth, typename... Codec>
+void ReadFrom(int fd, Vector<T, Alloc, Growth>& v, const Codec&... codec) {
+    static_assert(sizeof...(Codec) <= 1);
+    VectorFdSource source(fd);
+    ReadVector(source, v, codec...);
+}
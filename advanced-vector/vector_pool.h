@@ -0,0 +1,85 @@
+#pragma once
+#include "vector.h"
+
+#include <cstddef>
+#include <memory>
+
+// Пул буферов для векторов, которые создаются, заполняются и выбрасываются много раз:
+// Release забирает у вектора буфер (Vector::ReleaseStorage), а Acquire отдаёт пустой вектор
+// с одним из сохранённых буферов (Vector::AdoptStorage). В установившемся режиме, когда
+// векторы не растут больше прежнего, выделений памяти нет совсем.
+// Пул хранит не больше max_buffers буферов и не берёт буферы больше max_bytes байт,
+// чтобы разовый всплеск не удерживал память навсегда.
+// Пул не потокобезопасен: Local() даёт отдельный пул каждому потоку
+template <typename T, typename Alloc = std::allocator<T>>
+class VectorPool {
+public:
+    static constexpr size_t kDefaultMaxBuffers = 16;
+    static constexpr size_t kDefaultMaxBytes = 1024 * 1024;
+
+    explicit VectorPool(size_t max_buffers = kDefaultMaxBuffers, size_t max_bytes = kDefaultMaxBytes,
+                        const Alloc& alloc = Alloc()) noexcept
+        : max_buffers_(max_buffers)
+        , max_bytes_(max_bytes)
+        , alloc_(alloc) {
+    }
+
+    VectorPool(const VectorPool&) = delete;
+    VectorPool& operator=(const VectorPool&) = delete;
+
+    // Пул текущего потока с настройками по умолчанию
+    static VectorPool& Local() {
+        thread_local VectorPool pool;
+        return pool;
+    }
+
+    // Пустой вектор ёмкостью не меньше min_capacity. Предпочитается последний возвращённый
+    // буфер подходящего размера: его память, скорее всего, ещё в кеше. Если подходящего буфера нет,
+    // пул не меняется, а вектор получает новый буфер
+    Vector<T, Alloc> Acquire(size_t min_capacity = 0) {
+        Vector<T, Alloc> v(alloc_);
+        for (size_t i = buffers_.Size(); i-- > 0;) {
+            if (buffers_[i].Capacity() >= min_capacity) {
+                v.AdoptStorage(std::move(buffers_[i]));
+                buffers_.EraseUnordered(buffers_.cbegin() + i);
+                return v;
+            }
+        }
+        v.Reserve(min_capacity);
+        return v;
+    }
+
+    // Разрушает элементы v и сохраняет его буфер, если в пуле есть место.
+    // Иначе буфер освобождается. v остаётся пустым
+    void Release(Vector<T, Alloc>& v) {
+        RawMemory<T, Alloc> storage = v.ReleaseStorage();
+        if (storage.Capacity() == 0 || storage.Capacity() > max_bytes_ / sizeof(T)
+            || buffers_.Size() >= max_buffers_) {
+            return;
+        }
+        if (buffers_.Capacity() == 0) {
+            buffers_.Reserve(max_buffers_);
+        }
+        buffers_.EmplaceBack(std::move(storage));
+    }
+
+    void Release(Vector<T, Alloc>&& v) {
+        Release(v);
+    }
+
+    // Количество сохранённых буферов
+    size_t Size() const noexcept {
+        return buffers_.Size();
+    }
+
+    // Освобождает все сохранённые буферы
+    void Clear() noexcept {
+        buffers_.Clear();
+    }
+
+private:
+    Vector<RawMemory<T, Alloc>> buffers_;
+    size_t max_buffers_;
+    size_t max_bytes_;
+    Alloc alloc_;
+};
@@ -0,0 +1,123 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <initializer_list>
+#include <type_traits>
+
+// Инструментирование RawMemory и Vector. Включается макросом ADVANCED_VECTOR_STATS,
+// который нужно определить до подключения vector.h. Без него VECTOR_STATS_RECORD
+// ничего не делает, и инструментирование ничего не стоит
+
+enum class VectorEvent {
+    kAllocate,         // выделение буфера, amount - размер в байтах
+    kDeallocate,       // освобождение буфера, amount - размер в байтах
+    kReallocate,       // перенос элементов в новый или выросший буфер, amount - количество элементов
+    kMove,             // перемещение элементов конструктором перемещения, amount - количество элементов
+    kCopy,             // копирование элементов вместо перемещения, amount - количество элементов
+    kRelocate,         // побайтовый перенос элементов, amount - количество байт
+    kShiftingEmplace,  // вставка в середину со сдвигом хвоста, amount - длина сдвинутого хвоста
+    kErase,            // удаление элементов, amount - количество удалённых элементов
+    kResize,           // рост блока на месте (try_expand или reallocate аллокатора), amount - прирост в байтах
+};
+
+// Обработчик событий. Вызывается синхронно из операций вектора, поэтому должен быть быстрым
+// и не бросать исключений
+using VectorStatsCallback = void (*)(VectorEvent event, size_t amount) noexcept;
+
+// Глобальные счётчики событий всех векторов программы
+struct VectorStats {
+    std::atomic<size_t> allocations{0};
+    std::atomic<size_t> allocated_bytes{0};
+    std::atomic<size_t> deallocations{0};
+    std::atomic<size_t> deallocated_bytes{0};
+    std::atomic<size_t> reallocations{0};
+    std::atomic<size_t> moved_elements{0};
+    std::atomic<size_t> copied_elements{0};
+    std::atomic<size_t> relocated_bytes{0};
+    std::atomic<size_t> shifting_emplaces{0};
+    std::atomic<size_t> erased_elements{0};
+    std::atomic<size_t> resized_bytes{0};
+
+    void Reset() noexcept {
+        for (std::atomic<size_t>* counter : {&allocations, &allocated_bytes, &deallocations, &deallocated_bytes,
+                                             &reallocations, &moved_elements, &copied_elements, &relocated_bytes,
+                                             &shifting_emplaces, &erased_elements, &resized_bytes}) {
+            counter->store(0, std::memory_order_relaxed);
+        }
+    }
+};
+
+inline VectorStats& GetVectorStats() noexcept {
+    static VectorStats stats;
+    return stats;
+}
+
+inline std::atomic<VectorStatsCallback>& VectorStatsCallbackSlot() noexcept {
+    static std::atomic<VectorStatsCallback> callback{nullptr};
+    return callback;
+}
+
+// Устанавливает обработчик событий (nullptr отключает его)
+inline void SetVectorStatsCallback(VectorStatsCallback callback) noexcept {
+    VectorStatsCallbackSlot().store(callback, std::memory_order_release);
+}
+
+inline void RecordVectorEvent(VectorEvent event, size_t amount) noexcept {
+    VectorStats& stats = GetVectorStats();
+    const auto add = [amount](std::atomic<size_t>& counter) {
+        counter.fetch_add(amount, std::memory_order_relaxed);
+    };
+    const auto increment = [](std::atomic<size_t>& counter) {
+        counter.fetch_add(1, std::memory_order_relaxed);
+    };
+
+    switch (event) {
+        case VectorEvent::kAllocate:
+            increment(stats.allocations);
+            add(stats.allocated_bytes);
+            break;
+        case VectorEvent::kDeallocate:
+            increment(stats.deallocations);
+            add(stats.deallocated_bytes);
+            break;
+        case VectorEvent::kReallocate:
+            increment(stats.reallocations);
+            break;
+        case VectorEvent::kMove:
+            add(stats.moved_elements);
+            break;
+        case VectorEvent::kCopy:
+            add(stats.copied_elements);
+            break;
+        case VectorEvent::kRelocate:
+            add(stats.relocated_bytes);
+            break;
+        case VectorEvent::kShiftingEmplace:
+            increment(stats.shifting_emplaces);
+            break;
+        case VectorEvent::kErase:
+            add(stats.erased_elements);
+            break;
+        case VectorEvent::kResize:
+            add(stats.resized_bytes);
+            break;
+    }
+
+    if (VectorStatsCallback callback = VectorStatsCallbackSlot().load(std::memory_order_acquire)) {
+        callback(event, amount);
+    }
+}
+
+#if defined(ADVANCED_VECTOR_STATS) && defined(__cpp_lib_is_constant_evaluated)
+// Константные вычисления не могут обращаться к атомарным счётчикам и не учитываются
+#define VECTOR_STATS_RECORD(event, amount) \
+    do { \
+        if (!std::is_constant_evaluated()) { \
+            RecordVectorEvent((event), (amount)); \
+        } \
+    } while (false)
+#elif defined(ADVANCED_VECTOR_STATS)
+#define VECTOR_STATS_RECORD(event, amount) RecordVectorEvent((event), (amount))
+#else
+#define VECTOR_STATS_RECORD(event, amount) ((void)0)
+#endif